@@ -2,6 +2,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <pthread.h>
+
 // static const uint32_t gen = 0x2;                // 𝑥
 // static const uint32_t irr_poly = 0x43;          // 𝑥⁶ + 𝑥 + 1
 // static const uint32_t field_charac = (1 << 6);  // 2 ** 6
@@ -281,7 +283,7 @@ void encode63_30(uint8_t data[8]) {
     data[7] = (rem << 1) | 1;
 }
 
-int check63_45(const uint8_t data[8]) {
+static uint32_t remainder63_45(const uint8_t data[8]) {
     const uint32_t poly = generator18 << (32 - 18);
     uint32_t rem = 0;
 
@@ -306,9 +308,62 @@ int check63_45(const uint8_t data[8]) {
                 rem = (rem << 1);
         }
     }
-    return (rem >> (32 - 18)) == 0;
+    return rem >> (32 - 18);
 }
 
+int check63_45(const uint8_t data[8]) {
+    return remainder63_45(data) == 0;
+}
+
+
+// Error pattern of weight <= 3 for every 18-bit remainder, as a big-endian 64-bit mask, zero
+// where no such pattern exists. The remainder is linear in the received word and distinct for
+// each correctable pattern, so the table holds 1 + 63 + 1953 + 39711 entries out of 2^18.
+static uint64_t err_table63_45[1 << 18];
+static pthread_once_t err_table63_45_once = PTHREAD_ONCE_INIT;
+
+static void build_err_table63_45(void) {
+    uint32_t single[64];
+    for (unsigned i = 1; i < 64; ++i) {
+        uint8_t word[8] = {0};
+        word[7 - i / 8] = 1 << (i % 8);
+        single[i] = remainder63_45(word);
+    }
+
+    for (unsigned i = 1; i < 64; ++i) {
+        err_table63_45[single[i]] = 1ull << i;
+        for (unsigned j = i + 1; j < 64; ++j) {
+            err_table63_45[single[i] ^ single[j]] = (1ull << i) | (1ull << j);
+            for (unsigned k = j + 1; k < 64; ++k)
+                err_table63_45[single[i] ^ single[j] ^ single[k]] = (1ull << i) | (1ull << j) | (1ull << k);
+        }
+    }
+}
+
+// Builds the table once; decode63_45_lut calls it on first use. Safe from any thread, and
+// calling it up front keeps the build out of the first decode.
+void decode63_45_lut_init(void) {
+    pthread_once(&err_table63_45_once, build_err_table63_45);
+}
+
+// Table-driven decode63_45: one load instead of Berlekamp-Massey and the search over 63
+// positions. Same result for up to 3 errors; past that it only ever returns a codeword.
+int decode63_45_lut(uint8_t data[8]) {
+    decode63_45_lut_init();
+
+    uint32_t rem = remainder63_45(data);
+    if (rem == 0)
+        return 1;
+
+    uint64_t mask = err_table63_45[rem];
+    if (mask == 0)
+        return 0;
+
+    for (unsigned i = 0; i < 8; ++i)
+        data[i] ^= mask >> (56 - 8 * i);
+
+    return 1;
+}
 
 int decode63_45(uint8_t data[8]) {
     uint8_t synds[6];
@@ -1,6 +1,7 @@
 import ctypes
 import os
 import random
+import threading
 import time
 
 import gf
@@ -9,12 +10,13 @@ import bch
 def load_bchlib(recompile=False):
     if (recompile or not os.path.exists('./bch') or
         os.path.getctime('./bch') < os.path.getctime('./bch.c')):
-        os.system('gcc -O3 -Wall -shared ./bch.c -o bch')
+        os.system('gcc -O3 -Wall -shared -pthread ./bch.c -o bch')
 
     c_lib = ctypes.CDLL('./bch')
 
     c_lib.decode63_45.restype = ctypes.c_bool
     c_lib.decode63_30.restype = ctypes.c_bool
+    c_lib.decode63_45_lut.restype = ctypes.c_bool
     c_lib.check63_45.restype = ctypes.c_bool
     # c_lib.gf_mul.restype = ctypes.c_uint8
     # c_lib.gf_div.restype = ctypes.c_uint8
@@ -133,12 +135,64 @@ def test18(seed):
 
     # assert data_corr == data_orig, seed
 
+def test18_lut(seed):
+    random.seed(seed)
+    data_orig = random.randrange(0, 2 ** 45)
+
+    data_tx = ctypes.create_string_buffer((data_orig << (18 + 1)).to_bytes(8, 'big'))
+    bchlib.encode63_45(data_tx)
+    data_tx = int.from_bytes(data_tx[:8], 'big')
+
+    data_rx = data_tx
+    errors = random.sample(range(1, 64), random.randrange(0, 7))
+    for i in errors:
+        data_rx ^= 1 << i
+
+    data_ref = ctypes.create_string_buffer(data_rx.to_bytes(8, 'big'))
+    data_lut = ctypes.create_string_buffer(data_rx.to_bytes(8, 'big'))
+    ok = bchlib.decode63_45_lut(data_lut)
+
+    if len(errors) <= 3:
+        assert ok and bchlib.decode63_45(data_ref), seed
+        assert data_lut.raw == data_ref.raw, seed
+        assert int.from_bytes(data_lut[:8], 'big') == data_tx, seed
+    else:
+        # success means a codeword within 3 bits of the received word
+        flipped = int.from_bytes(data_lut[:8], 'big') ^ data_rx
+        assert not ok or (bchlib.check63_45(data_lut) and bin(flipped).count('1') <= 3), seed
+        assert ok or flipped == 0, seed
+
+def test18_lut_threads(seed):
+    # first use from several threads at once; ctypes drops the GIL around the calls
+    random.seed(seed)
+    words = []
+    for _ in range(8):
+        data_tx = ctypes.create_string_buffer((random.randrange(0, 2 ** 45) << (18 + 1)).to_bytes(8, 'big'))
+        bchlib.encode63_45(data_tx)
+        words.append(int.from_bytes(data_tx[:8], 'big'))
+
+    results = [None] * len(words)
+    def worker(i):
+        rx = words[i] ^ (1 << random.randrange(1, 64))
+        data = ctypes.create_string_buffer(rx.to_bytes(8, 'big'))
+        results[i] = bchlib.decode63_45_lut(data) and int.from_bytes(data[:8], 'big') == words[i]
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(len(words))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    assert all(results), seed
+
 if __name__ == '__main__':
     seed = random.randrange(0, 2 ** 64)
 
     bchlib = load_bchlib()
+    test18_lut_threads(seed)
 
     for i in range(100000):
         test33(seed)
         test18(seed)
+        test18_lut(seed)
         seed = random.randrange(0, 2 ** 64)
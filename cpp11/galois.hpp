@@ -1,37 +1,53 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
 template<uint8_t primitive, uint16_t poly1>
 struct GF {
-    static_assert((poly1 & 0x80) == 0); // needed for mul4 and mul8
+    static_assert((poly1 & 0x80) == 0, "needed for mul4 and mul8");
     static const uint32_t poly4 = (poly1 & 0xff) * 0x01010101;
     static const uint64_t poly8 = (poly1 & 0xff) * 0x0101010101010101;
 
-    std::array<uint8_t, 256> exp_table;
-    std::array<uint8_t, 256> log_table;
+    // Built once per field on first use and shared by every GF object; initialization of
+    // function-local statics is thread-safe since C++11
+    struct tables_t {
+        std::array<uint8_t, 256> exp;
+        std::array<uint8_t, 256> log;
 #ifdef GF_MUL_TABLE
-    std::array<std::array<uint8_t, 256>, 256> mul_table;
+        std::array<std::array<uint8_t, 256>, 256> mul;
 #endif
 
-    inline GF() {
-        uint8_t x = 1;
-        for (unsigned i = 0; i < 256; ++i) {
-            exp_table[i] = x;
-            log_table[x] = i;
-            x = _mul(x, primitive);
-        }
+        inline tables_t() {
+            uint8_t x = 1;
+            for (unsigned i = 0; i < 256; ++i) {
+                exp[i] = x;
+                log[x] = i;
+                x = _mul(x, primitive);
+            }
 
 #ifdef GF_MUL_TABLE
-        for (unsigned i = 0; i < 256; ++i) {
-            for (unsigned j = 0; j < 256; ++j)
-                mul_table[i][j] = _mul(i, j);
-        }
+            for (unsigned i = 0; i < 256; ++i) {
+                for (unsigned j = 0; j < 256; ++j)
+                    mul[i][j] = _mul(i, j);
+            }
 #endif
+        }
+    };
+
+    static inline const tables_t& shared_tables() {
+        static const tables_t shared;
+        return shared;
     }
 
-    inline uint8_t _mul(uint8_t a, uint8_t b) {
+    const tables_t *tables;
+
+    inline GF() : tables(&shared_tables()) { }
+
+    static inline uint8_t _mul(uint8_t a, uint8_t b) {
         uint8_t r = 0;
         for (int i = 7; i >= 0; --i) {
             if (r & 0x80)
@@ -48,18 +64,18 @@ struct GF {
 
 #ifdef GF_MUL_TABLE
     inline uint8_t mul(uint8_t a, uint8_t b) {
-        return mul_table[a][b];
+        return tables->mul[a][b];
     }
 #else
     inline uint8_t mul(uint8_t a, uint8_t b) {
         if (a == 0 || b == 0)
             return 0;
 
-        unsigned r = log_table[a] + log_table[b];
+        unsigned r = tables->log[a] + tables->log[b];
         if (r >= 255)
             r -= 255;
 
-        return exp_table[r];
+        return tables->exp[r];
     }
 #endif
 
@@ -96,26 +112,26 @@ struct GF {
     }
 
     inline uint8_t inv(uint8_t a) {
-        return exp_table[255 - log_table[a]];
+        return tables->exp[255 - tables->log[a]];
     }
 
     inline uint8_t div(uint8_t a, uint8_t b) {
         if (a == 0)
             return 0;
 
-        unsigned r = log_table[a] + 255 - log_table[b];
+        unsigned r = tables->log[a] + 255 - tables->log[b];
         if (r >= 255)
             r -= 255;
 
-        return exp_table[r];
+        return tables->exp[r];
     }
 
     inline uint8_t exp(uint8_t a) {
-        return exp_table[a];
+        return tables->exp[a];
     }
 
     inline uint8_t log(uint8_t a) {
-        return log_table[a];
+        return tables->log[a];
     }
 
     inline unsigned ex_synth_div(uint8_t a[], unsigned size_a, const uint8_t b[], unsigned size_b) {
@@ -219,6 +235,20 @@ struct GF {
         return r;
     }
 
+    // Evaluates poly at N words of points in one pass over it; the independent Horner chains
+    // overlap in the pipeline instead of rereading poly once per word
+    template<unsigned N, typename Word>
+    inline void poly_eval_wide(const uint8_t poly[], const unsigned size, const Word x[], Word r[]) {
+        for (unsigned k = 0; k < N; ++k)
+            r[k] = 0;
+
+        for (unsigned i = 0; i < size; ++i) {
+            Word c = poly[i] * (Word(~Word(0)) / 0xff);
+            for (unsigned k = 0; k < N; ++k)
+                r[k] = mul(r[k], x[k]) ^ c;
+        }
+    }
+
     inline void poly_shift(uint8_t poly[], const unsigned size, const unsigned n) {
         unsigned i = 0;
         for (; i < size - n; ++i)
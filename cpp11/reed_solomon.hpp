@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <functional>
 #include <memory>
@@ -9,103 +10,153 @@
 
 template<unsigned ecc, uint8_t gf_base = 2, uint16_t gf_poly = 0x11d, typename Word = unsigned>
 struct RS {
-    static_assert(ecc < 255);
+    static_assert(ecc < 255, "ecc must leave room for data in a 255-byte codeword");
 
     static const unsigned ecc_w = (ecc / sizeof(Word)) + !!(ecc % sizeof(Word));
 
-#ifndef RS_ENCODE_ONLY
-    GF<gf_base, gf_poly> gf;
+    // Bytes of input the table encoder consumes per step, RS_ENCODE_SLICE=N for slice-by-N
+#ifdef RS_ENCODE_SLICE
+    static const unsigned slices = RS_ENCODE_SLICE;
+#else
+    static const unsigned slices = 1;
 #endif
-    std::array<uint8_t, ecc + 1> generator;
-    alignas(Word) std::array<uint8_t, ecc_w * sizeof(Word)> generator_roots;
+    static const unsigned slice_w = (slices + sizeof(Word) - 1) / sizeof(Word);
+    static_assert(slices == 1 || slices % sizeof(Word) == 0, "slices must be whole words");
+
+    // Root search evaluates this many words of candidate roots per pass over the error locator
+    static const unsigned roots_w = 4;
+
+    // Generator and lookup tables, built on first use and shared by every RS object with the
+    // same parameters, so that constructing a codec is only taking their address
+    struct tables_t {
+        std::array<uint8_t, ecc + 1> generator;
+        alignas(Word) std::array<uint8_t, ecc_w * sizeof(Word)> generator_roots;
 #if defined(RS_GENERATOR_LUT) || defined(RS_ENCODE_ONLY)
-    alignas(Word) std::array<std::array<uint8_t, ecc_w * sizeof(Word)>, 256> generator_lut;
+        // generator_lut[j][i]: remainder of i * x^(ecc + j), byte k of the remainder in
+        // bits 8 * (k % sizeof(Word)) of word k / sizeof(Word)
+        std::array<std::array<std::array<Word, ecc_w>, 256>, slices> generator_lut;
 #endif
 #ifdef RS_POLY_ROOT_LUT
-    alignas(Word) std::array<uint8_t, 256> err_poly_roots;
+        alignas(Word) std::array<uint8_t, 256> err_poly_roots;
 #endif
 
-    inline RS() {
-#ifdef RS_ENCODE_ONLY
-        GF<gf_base, gf_poly> gf;
-#endif
+        inline tables_t() {
+            GF<gf_base, gf_poly> gf;
 
-        std::array<uint8_t, ecc + 1> temp = {};
+            std::array<uint8_t, ecc + 1> temp = {};
 
-        auto p1 = (ecc & 1) ? &generator[0] : &temp[0];
-        auto p2 = (ecc & 1) ? &temp[0] : &generator[0];
+            auto p1 = (ecc & 1) ? &generator[0] : &temp[0];
+            auto p2 = (ecc & 1) ? &temp[0] : &generator[0];
 
-        unsigned len = 1;
-        p2[0] = 1;
+            unsigned len = 1;
+            p2[0] = 1;
 
-        for (unsigned i = 0; i < ecc; ++i) {
-            uint8_t factor[] = {1, gf.exp(i)};
-            len = gf.poly_mul(p1, p2, len, factor, 2);
+            for (unsigned i = 0; i < ecc; ++i) {
+                uint8_t factor[] = {1, gf.exp(i)};
+                len = gf.poly_mul(p1, p2, len, factor, 2);
 
-            auto t = p1;
-            p1 = p2;
-            p2 = t;
-        }
+                auto t = p1;
+                p1 = p2;
+                p2 = t;
+            }
 
-        for (unsigned i = 0; i < ecc; ++i)
-            generator_roots[i] = gf.exp(i);
+            for (unsigned i = 0; i < ecc; ++i)
+                generator_roots[i] = gf.exp(i);
 
 #if defined(RS_GENERATOR_LUT) || defined(RS_ENCODE_ONLY)
-        for (unsigned i = 0; i < 256; ++i) {
-            uint8_t data[ecc + 1] = {uint8_t(i)};
-            gf.ex_synth_div(&data[0], ecc + 1, &generator[0], ecc + 1);
+            for (unsigned i = 0; i < 256; ++i) {
+                uint8_t data[ecc + 1] = {uint8_t(i)};
+                gf.ex_synth_div(&data[0], ecc + 1, &generator[0], ecc + 1);
 
-            if (ecc == sizeof(Word)) {
-                for (unsigned j = 0; j < ecc; ++j)
-                    generator_lut[i][ecc - 1 - j] = data[j + 1];
-            } else {
+                generator_lut[0][i].fill(0);
                 for (unsigned j = 0; j < ecc; ++j)
-                    generator_lut[i][j] = data[j + 1];
+                    generator_lut[0][i][j / sizeof(Word)] |= Word(data[j + 1]) << 8 * (j % sizeof(Word));
+            }
+
+            // one more zero byte through the encoder per slice
+            for (unsigned j = 1; j < slices; ++j) {
+                for (unsigned i = 0; i < 256; ++i) {
+                    generator_lut[j][i] = generator_lut[j - 1][i];
+                    shift_in(&generator_lut[j][i][0], &generator_lut[0][0][0], 0);
+                }
             }
-        }
 #endif
 
 #ifdef RS_POLY_ROOT_LUT
-        for (unsigned i = 0; i < 256; ++i)
-            err_poly_roots[i] = gf.inv(gf.exp(i));
+            for (unsigned i = 0; i < 256; ++i)
+                err_poly_roots[i] = gf.inv(gf.exp(i));
 #endif
+        }
+    };
+
+    static inline const tables_t& shared_tables() {
+        static const tables_t shared;
+        return shared;
     }
 
-#if defined(RS_GENERATOR_LUT) || defined(RS_ENCODE_ONLY)
-    inline void encode(uint8_t *data, unsigned size) {
-        auto data_len = size - ecc;
-        auto rem = &data[data_len];
+#ifndef RS_ENCODE_ONLY
+    GF<gf_base, gf_poly> gf;
+#endif
+    const tables_t *tables;
 
-        if (ecc == sizeof(Word)) {
-            auto lut = reinterpret_cast<const Word *>(&generator_lut[0][0]);
-            const unsigned shift = (sizeof(Word) - 1) * 8;
+    inline RS() : tables(&shared_tables()) { }
 
-            Word w = 0;
-            for (unsigned i = 0; i < data_len; ++i) {
-                uint8_t pos = (w ^ (Word(data[i]) << shift)) >> shift;
+#if defined(RS_GENERATOR_LUT) || defined(RS_ENCODE_ONLY)
+    static inline Word load_word(const uint8_t *p) {
+        Word w = 0;
+        for (unsigned j = 0; j < sizeof(Word); ++j)
+            w |= Word(p[j]) << 8 * j;
+        return w;
+    }
 
-                w = (w << 8) ^ lut[pos];
-            }
+    // One byte through the encoder: the remainder moves up one byte and the feedback byte
+    // selects the remainder to add from lut, the generator_lut[0] table
+    static inline void shift_in(Word rem[ecc_w], const Word *lut, uint8_t byte) {
+        auto entry = &lut[(uint8_t(rem[0]) ^ byte) * ecc_w];
+        for (unsigned w = 0; w < ecc_w; ++w) {
+            Word next = (w + 1 < ecc_w) ? rem[w + 1] << (8 * sizeof(Word) - 8) : 0;
+            rem[w] = ((rem[w] >> 8) | next) ^ entry[w];
+        }
+    }
 
-            // std::copy_n(reinterpret_cast<const uint8_t *>(&w), ecc, rem);
-            for (unsigned i = 0; i < ecc; ++i)
-                rem[i] = w >> (shift - 8 * i);
-        } else {
-            std::memset(rem, 0, ecc);
-            for (unsigned i = 0; i < data_len; ++i) {
-                uint8_t pos = rem[0] ^ data[i];
-                rem[0] = 0;
-                std::rotate(rem, rem + 1, rem + ecc);
-                std::transform(rem, rem + ecc,
-                        &generator_lut[pos][0],
-                        rem, std::bit_xor<uint8_t>());
+    inline void encode(uint8_t *data, unsigned size) {
+        auto data_len = size - ecc;
+        Word rem[ecc_w] = {};
+        unsigned i = 0;
+
+        if (slices > 1) {
+            // slice-by-N: every byte of the block feeds its own table, generator_lut[j] holding
+            // the remainders after j more bytes, and the block leaves the remainder in one step
+            for (; data_len - i >= slices; i += slices) {
+                Word t[ecc_w] = {};
+
+                for (unsigned k = 0; k < slice_w; ++k) {
+                    Word b = load_word(&data[i + k * sizeof(Word)]);
+                    if (k < ecc_w)
+                        b ^= rem[k];
+
+                    for (unsigned j = 0; j < sizeof(Word); ++j) {
+                        auto& entry = tables->generator_lut[slices - 1 - k * sizeof(Word) - j][uint8_t(b >> 8 * j)];
+                        for (unsigned w = 0; w < ecc_w; ++w)
+                            t[w] ^= entry[w];
+                    }
+                }
+
+                for (unsigned w = 0; w < ecc_w; ++w)
+                    rem[w] = (w + slice_w < ecc_w ? rem[w + slice_w] : 0) ^ t[w];
             }
         }
+
+        for (; i < data_len; ++i)
+            shift_in(rem, &tables->generator_lut[0][0][0], data[i]);
+
+        for (unsigned j = 0; j < ecc; ++j)
+            data[data_len + j] = rem[j / sizeof(Word)] >> 8 * (j % sizeof(Word));
     }
 #else
     inline void encode(uint8_t *data, unsigned size) {
         auto data_len = size - ecc;
-        gf.poly_mod_x_n(&data[data_len], data, data_len, &generator[1], ecc);
+        gf.poly_mod_x_n(&data[data_len], data, data_len, &tables->generator[1], ecc);
     }
 #endif
 
@@ -113,10 +164,9 @@ struct RS {
     inline void decode(uint8_t *data, unsigned size) {
         Word synds_w[ecc_w];
         auto synds = reinterpret_cast<uint8_t *>(synds_w);
-        auto gen_roots = reinterpret_cast<const Word *>(&generator_roots[0]);
+        auto gen_roots = reinterpret_cast<const Word *>(&tables->generator_roots[0]);
 
-        for (unsigned i = 0; i < ecc_w; ++i)
-            synds_w[i] = gf.poly_eval(data, size, gen_roots[i]);
+        gf.template poly_eval_wide<ecc_w>(data, size, gen_roots, synds_w);
 
         if (std::all_of(synds, synds + ecc, std::logical_not<uint8_t>()))
             return;
@@ -191,17 +241,19 @@ struct RS {
         unsigned count = 0;
 
 #ifdef RS_POLY_ROOT_LUT
-        auto err_poly_roots_64 = reinterpret_cast<const Word *>(&err_poly_roots[0]);
-        for (unsigned i = 0; i <= size/sizeof(Word); ++i) {
-            Word eval = gf.poly_eval(poly, poly_size, err_poly_roots_64[i]);
-            for (unsigned j = 0; j < 8; ++j) {
-                if (reinterpret_cast<uint8_t *>(&eval)[j] == 0) {
-                    auto pos = i * 8 + j;
-
-                    if (pos < size)
-                        roots[count++] = pos;
-                    else
-                        break;
+        static const unsigned group = roots_w * sizeof(Word);
+        auto err_poly_roots_w = reinterpret_cast<const Word *>(&tables->err_poly_roots[0]);
+
+        for (unsigned i = 0; i < size; i += group) {
+            Word eval_w[roots_w];
+            auto eval = reinterpret_cast<const uint8_t *>(eval_w);
+            gf.template poly_eval_wide<roots_w>(poly, poly_size, &err_poly_roots_w[i / sizeof(Word)], eval_w);
+
+            for (unsigned j = 0; j < group && i + j < size; ++j) {
+                if (eval[j] == 0) {
+                    roots[count] = i + j;
+                    if (++count >= poly_size - 1)
+                        return count;
                 }
             }
         }
@@ -221,7 +273,7 @@ struct RS {
     {
         uint8_t temp[ecc] = {1};
 
-        uint8_t err_eval[ecc * 2];
+        uint8_t err_eval[ecc * 2] = {};
         uint8_t synds_rev[ecc];
         std::reverse_copy(synds, &synds[ecc], synds_rev);
 
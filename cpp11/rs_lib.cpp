@@ -1,7 +1,10 @@
+// test_rs_cpp.py builds this twice: with -DRS_POLY_ROOT_LUT -DRS_ENCODE_SLICE=8 and without
 #define RS_GENERATOR_LUT
 #include "reed_solomon.hpp"
 
 using RS0 = RS<4, 2, 0x11d, uint32_t>;
+// remainder and syndromes over several words
+using RS1 = RS<16, 2, 0x11d, uint64_t>;
 
 extern "C" {
 
@@ -13,6 +16,10 @@ void gf_uninit(void *rs) {
     delete reinterpret_cast<RS0 *>(rs);
 }
 
+unsigned rs_sizeof(void *) {
+    return sizeof(RS0);
+}
+
 uint8_t gf_mul(void *rs, uint8_t a, uint8_t b) {
     return reinterpret_cast<RS0 *>(rs)->gf.mul(a, b);
 }
@@ -57,4 +64,12 @@ void decode(void *rs, uint8_t a[], unsigned size) {
     return reinterpret_cast<RS0 *>(rs)->decode(a, size);
 }
 
+void encode16(uint8_t a[], unsigned size) {
+    RS1().encode(a, size);
+}
+
+void decode16(uint8_t a[], unsigned size) {
+    RS1().decode(a, size);
+}
+
 }
@@ -10,8 +10,8 @@ import bch
 import rs
 
 class RSC:
-    def __init__(self, power, prim, poly, ecc_len):
-        self.c_lib = ctypes.CDLL('./rs_lib.so')
+    def __init__(self, path, power, prim, poly, ecc_len):
+        self.c_lib = ctypes.CDLL(path)
 
         self.c_lib.gf_mul.restype       = ctypes.c_uint8
         self.c_lib._mul.restype         = ctypes.c_uint8
@@ -23,7 +23,7 @@ class RSC:
         self.c_lib.gf_poly_eval.restype = ctypes.c_uint8
         self.c_lib.gf_poly_eval4.restype= ctypes.c_uint32
 
-        self.gf_ctx = self.c_lib.gf_init()
+        self.gf_ctx = ctypes.c_void_p(self.c_lib.gf_init())
 
     def _mul(self, a, b):
         return self.c_lib._mul(self.gf_ctx, ctypes.c_uint8(a), ctypes.c_uint8(b))
@@ -78,13 +78,16 @@ class RSC:
         self.c_lib.decode(self.gf_ctx, res, len(a))
         return list(res)
 
-os.system('g++ -O3 -Wall -shared -DSHARED ./rs_lib.cpp -o rs_lib.so')
+# slice-by-8 encoding and the root lookup table, and the plain build of the same exports
+os.system('g++ -std=c++11 -O3 -Wall -shared -fPIC -DSHARED -DRS_POLY_ROOT_LUT -DRS_ENCODE_SLICE=8 ./rs_lib.cpp -o rs_lib.so')
+os.system('g++ -std=c++11 -O3 -Wall -shared -fPIC -DSHARED ./rs_lib.cpp -o rs_lib_plain.so')
 
 ecc_len = 4
 GF = rs.GF
 poly = GF.poly_to_int(GF.p, GF.poly)
 print(f'init field: power: {GF.k} prim: {GF.a} poly: 0x{poly:x}')
-RS = RSC(GF.k, GF.a, poly, ecc_len)
+RS = RSC('./rs_lib.so', GF.k, GF.a, poly, ecc_len)
+RS_plain = RSC('./rs_lib_plain.so', GF.k, GF.a, poly, ecc_len)
 
 def assert_eq(a, b, l, r):
     assert l == r, (int(a), int(b), int(l), int(r))
@@ -216,6 +219,50 @@ def test_decode():
             print(f'ref:  {ref}')
             assert False
 
+def test_encode_slice(RS):
+    # lengths around the 8-byte slices, for a remainder narrower and wider than one slice
+    for ecc, enc_fn in ((ecc_len, RS.c_lib.encode), (16, None)):
+        gen = rs.rs_generator(ecc)
+        for n in range(1, 60):
+            a = [random.randrange(GF.p ** GF.k) for _ in range(n)]
+
+            res = (ctypes.c_uint8 * (n + ecc))(*(a + [0] * ecc))
+            if enc_fn:
+                enc_fn(RS.gf_ctx, res, len(res))
+            else:
+                RS.c_lib.encode16(res, len(res))
+
+            ref = rs.rs_encode_systematic(a[::-1], gen)
+            ref = [0] * (len(res) - len(ref.x)) + list(map(int, ref[::-1]))
+
+            assert list(res) == ref, (n, ecc, list(res), ref)
+
+def test_decode_wide(RS):
+    for _ in range(500):
+        n = random.randrange(1, 255 - 16)
+        a = [random.randrange(GF.p ** GF.k) for _ in range(n)]
+
+        res = (ctypes.c_uint8 * (n + 16))(*(a + [0] * 16))
+        RS.c_lib.encode16(res, len(res))
+
+        for e in random.sample(range(len(res)), random.randrange(9)):
+            res[e] ^= random.randrange(1, 256)
+
+        RS.c_lib.decode16(res, len(res))
+        assert list(res[:n]) == a
+
+def test_shared_tables():
+    # codecs only point at the tables shared by every codec with the same parameters
+    assert RS.c_lib.rs_sizeof(RS.gf_ctx) <= 16
+
+    other = ctypes.c_void_p(RS.c_lib.gf_init())
+    for _ in range(100):
+        a = [random.randrange(GF.p ** GF.k) for _ in range(12)] + [0] * ecc_len
+        res = (ctypes.c_uint8 * len(a))(*a)
+        RS.c_lib.encode(other, res, len(a))
+        assert list(res) == RS.encode(a)
+    RS.c_lib.gf_uninit(other)
+
 if __name__ == '__main__':
     random.seed(42)
     # test_mul()
@@ -229,3 +276,7 @@ if __name__ == '__main__':
     # test_poly_mul()
     test_encode()
     # test_decode()
+    for lib in (RS, RS_plain):
+        test_encode_slice(lib)
+        test_decode_wide(lib)
+    test_shared_tables()
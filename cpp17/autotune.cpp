@@ -0,0 +1,202 @@
+// Measures the candidate policy packs for GF(2^8) codes on this host and writes a header
+// that picks the fastest encode, syndrome and root policies per ecc and message length.
+//
+// usage: autotune [--time seconds] [--clean-weight w] [--output rs_tuned.hpp]
+//
+// Decoders are ranked by w * (ns/codeword without errors) + (1 - w) * (ns/codeword with
+// ecc/2 errors), since most codewords in practice arrive clean.
+
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.hpp"
+#include "reed_solomon.hpp"
+
+using GF256 = GF<uint8_t, 2, 8, 2, 0x11d & 0xff, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+
+static constexpr unsigned short_length = 64;
+
+struct candidate {
+    std::string encode, synds, roots;                   // alias targets, in terms of RS
+    std::function<double(unsigned msglen)> measure;     // ns per codeword, lower is better
+};
+
+struct choice {
+    unsigned ecc;
+    bool is_short;
+    candidate const *encode;
+    candidate const *decode;
+    double encode_ns;
+    double decode_ns;
+};
+
+template<unsigned Ecc, template<class>typename Enc>
+static candidate encoder(bench::options const& opt, std::string expr) {
+    return {expr, "", "", [&opt](unsigned msglen) {
+        std::vector<bench::record> r;
+        bench::run_encode<RS<GF256, Ecc, Enc, rs_synds_lut8, rs_roots_eval_chien64, rs_decode>>(r, opt, "", msglen);
+        return r.back().ns_per_codeword;
+    }};
+}
+
+template<unsigned Ecc, template<class>typename Synds, template<class>typename Roots>
+static candidate decoder(bench::options const& opt, double clean_weight, std::string synds, std::string roots) {
+    return {"", synds, roots, [&opt, clean_weight](unsigned msglen) {
+        using RS = ::RS<GF256, Ecc, rs_encode_lut, Synds, Roots, rs_decode>;
+        std::vector<bench::record> r;
+        bench::run_decode<RS>(r, opt, "", msglen, 0);
+        bench::run_decode<RS>(r, opt, "", msglen, Ecc / 2);
+
+        if (r[0].failures || r[1].failures)
+            return 1e300;
+        return clean_weight * r[0].ns_per_codeword + (1 - clean_weight) * r[1].ns_per_codeword;
+    }};
+}
+
+template<unsigned Ecc, template<class>typename Synds>
+static void decoders(std::vector<candidate>& out, bench::options const& opt, double w, std::string synds) {
+    out.push_back(decoder<Ecc, Synds, rs_roots_eval_chien>(opt, w, synds, "rs_roots_eval_chien<RS>"));
+    out.push_back(decoder<Ecc, Synds, rs_roots_eval_chien64>(opt, w, synds, "rs_roots_eval_chien64<RS>"));
+    out.push_back(decoder<Ecc, Synds, rs_roots_eval_lut8>(opt, w, synds, "rs_roots_eval_lut8<RS>"));
+    out.push_back(decoder<Ecc, Synds, rs_roots_direct_t<rs_roots_eval_chien64>::type>(opt, w, synds,
+            "rs_roots_direct_t<rs_roots_eval_chien64>::type<RS>"));
+}
+
+template<unsigned Ecc>
+static void tune(std::vector<choice>& choices, std::deque<candidate>& storage,
+        bench::options const& opt, double w) {
+    std::vector<candidate> enc, dec;
+
+    enc.push_back(encoder<Ecc, rs_encode_basic>(opt, "rs_encode_basic<RS>"));
+    enc.push_back(encoder<Ecc, rs_encode_lut>(opt, "rs_encode_lut<RS>"));
+    if constexpr (Ecc == 4)
+        enc.push_back(encoder<Ecc, rs_encode_slice<uint32_t, 8>::type>(opt, "rs_encode_slice<uint32_t, 8>::type<RS>"));
+    if constexpr (Ecc == 8)
+        enc.push_back(encoder<Ecc, rs_encode_slice<uint64_t, 16>::type>(opt, "rs_encode_slice<uint64_t, 16>::type<RS>"));
+
+    decoders<Ecc, rs_synds_basic>(dec, opt, w, "rs_synds_basic<RS>");
+    decoders<Ecc, rs_synds_lut4>(dec, opt, w, "rs_synds_lut4<RS>");
+    decoders<Ecc, rs_synds_lut8>(dec, opt, w, "rs_synds_lut8<RS>");
+
+    // candidates are referenced by the choices, keep them alive; appending to a deque leaves
+    // existing elements in place
+    auto enc_first = storage.size();
+    storage.insert(storage.end(), enc.begin(), enc.end());
+    auto dec_first = storage.size();
+    storage.insert(storage.end(), dec.begin(), dec.end());
+
+    for (bool is_short : {true, false}) {
+        unsigned msglen = is_short ? short_length : 255 - Ecc;
+        choice c = {Ecc, is_short, nullptr, nullptr, 1e300, 1e300};
+
+        for (unsigned i = 0; i < enc.size(); ++i) {
+            auto& e = storage[enc_first + i];
+            double ns = e.measure(msglen);
+            if (ns < c.encode_ns) {
+                c.encode_ns = ns;
+                c.encode = &e;
+            }
+        }
+
+        for (unsigned i = 0; i < dec.size(); ++i) {
+            auto& d = storage[dec_first + i];
+            double ns = d.measure(msglen);
+            if (ns < c.decode_ns) {
+                c.decode_ns = ns;
+                c.decode = &d;
+            }
+        }
+
+        std::fprintf(stderr, "ecc %2u len %3u: %-40s %8.1f ns | %s + %s %8.1f ns\n", Ecc, msglen,
+                c.encode->encode.c_str(), c.encode_ns, c.decode->synds.c_str(), c.decode->roots.c_str(), c.decode_ns);
+        choices.push_back(c);
+    }
+}
+
+static bool write_header(std::FILE *f, std::vector<choice> const& choices) {
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%d", std::gmtime(&now));
+
+    std::fprintf(f, "// Generated by autotune on %s, %s. Do not edit; rerun autotune instead.\n", host, date);
+    std::fprintf(f, "#pragma once\n\n#include \"reed_solomon.hpp\"\n\n");
+    std::fprintf(f, "using rs_tuned_gf = GF<uint8_t, 2, 8, 2, 0x11d & 0xff, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;\n\n");
+    std::fprintf(f, "static constexpr unsigned rs_tuned_short_length = %u;\n\n", short_length);
+    std::fprintf(f, "namespace detail {\n");
+    std::fprintf(f, "    template<unsigned Ecc, bool Short>\n    struct rs_tuned_pack;\n");
+
+    for (auto& c : choices) {
+        std::fprintf(f, "\n    // encode %.1f ns/codeword, decode %.1f ns/codeword\n", c.encode_ns, c.decode_ns);
+        std::fprintf(f, "    template<>\n    struct rs_tuned_pack<%u, %s> {\n", c.ecc, c.is_short ? "true" : "false");
+        std::fprintf(f, "        template<typename RS> using encode = %s;\n", c.encode->encode.c_str());
+        std::fprintf(f, "        template<typename RS> using synds = %s;\n", c.decode->synds.c_str());
+        std::fprintf(f, "        template<typename RS> using roots = %s;\n", c.decode->roots.c_str());
+        std::fprintf(f, "    };\n");
+    }
+
+    std::fprintf(f, "}\n\n");
+    std::fprintf(f, "// Codec with the policies measured fastest for this ecc and message length\n");
+    std::fprintf(f, "template<unsigned Ecc, unsigned Length = 255 - Ecc>\n");
+    std::fprintf(f, "using rs_tuned = RS<rs_tuned_gf, Ecc,\n");
+    std::fprintf(f, "        detail::rs_tuned_pack<Ecc, (Length <= rs_tuned_short_length)>::template encode,\n");
+    std::fprintf(f, "        detail::rs_tuned_pack<Ecc, (Length <= rs_tuned_short_length)>::template synds,\n");
+    std::fprintf(f, "        detail::rs_tuned_pack<Ecc, (Length <= rs_tuned_short_length)>::template roots,\n");
+    std::fprintf(f, "        rs_decode>;\n");
+
+    return std::ferror(f) == 0;
+}
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr, "usage: %s [--time seconds] [--clean-weight w] [--output file]\n", argv0);
+}
+
+int main(int argc, char *argv[]) {
+    bench::options opt;
+    opt.seconds = 0.1;
+    double clean_weight = 0.9;
+    std::string output = "rs_tuned.hpp";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (arg == "--time")
+            opt.seconds = std::stod(argv[++i]);
+        else if (arg == "--clean-weight")
+            clean_weight = std::stod(argv[++i]);
+        else if (arg == "--output")
+            output = argv[++i];
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<choice> choices;
+    std::deque<candidate> storage;
+
+    tune<4>(choices, storage, opt, clean_weight);
+    tune<8>(choices, storage, opt, clean_weight);
+    tune<16>(choices, storage, opt, clean_weight);
+    tune<32>(choices, storage, opt, clean_weight);
+
+    std::FILE *f = std::fopen(output.c_str(), "w");
+    if (!f || !write_header(f, choices)) {
+        std::fprintf(stderr, "cannot write %s\n", output.c_str());
+        return 2;
+    }
+
+    std::fclose(f);
+    return 0;
+}
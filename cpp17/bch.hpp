@@ -0,0 +1,876 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "galois.hpp"
+
+// Binary BCH codes over GF(2^m), in the policy style of reed_solomon.hpp.
+//
+// A codeword of N bits is packed MSB first into (N + 7) / 8 bytes: K data bits followed by
+// the ecc parity bits. Bits past N in the last byte are left untouched. The first bit is the
+// coefficient of x^(N-1), so BCH<GF64, 3, 63> matches the layout of bch/bch.c. For sub-byte
+// fields the GF Poly1 must be the full reduction polynomial, e.g. 0x43 for GF(64).
+//
+// Codes with up to 64 parity bits keep the remainder in one uint64_t. Longer ones, like the
+// BCH<GF8k, 40, 4616> of a 512-byte flash sector, keep it top aligned in remainder_words words,
+// most significant first, and need bch_encode_lfsr.
+
+namespace detail {
+    // Degree of the product of the minimal polynomials of a^1 .. a^(2t-1)
+    template<typename GF>
+    static inline constexpr unsigned bch_generator_degree(unsigned t) {
+        constexpr unsigned order = GF::charact - 1;
+        unsigned degree = 0;
+
+        for (unsigned i = 1; i < 2 * t; i += 2) {
+            bool fresh = true;
+            unsigned size = 0;
+            unsigned e = i;
+            do {
+                fresh &= !(e < i && (e & 1));
+                e = (e * 2) % order;
+                ++size;
+            } while (e != i);
+
+            if (fresh)
+                degree += size;
+        }
+
+        return degree;
+    }
+
+    // Bit `pos` of an MSB-first bit string
+    static inline constexpr unsigned bch_bit(const uint8_t buf[], unsigned pos) {
+        return (buf[pos / 8] >> (7 - pos % 8)) & 1;
+    }
+
+    // Writes the top `count` bits of value to an MSB-first bit string, starting at bit `pos`
+    static inline void bch_put_bits(uint8_t buf[], unsigned pos, uint64_t value, unsigned count) {
+        for (unsigned i = 0; i < count; ++i, ++pos) {
+            uint8_t mask = uint8_t(0x80 >> (pos % 8));
+            buf[pos / 8] = (value >> (63 - i)) & 1 ? buf[pos / 8] | mask : buf[pos / 8] & ~mask;
+        }
+    }
+
+    // Shifts a multiword register, most significant word first, left by 0 < count < 64 bits
+    template<unsigned Words>
+    static inline constexpr void bch_shift_left(uint64_t reg[Words], unsigned count) {
+        for (unsigned w = 0; w + 1 < Words; ++w)
+            reg[w] = (reg[w] << count) | (reg[w + 1] >> (64 - count));
+        reg[Words - 1] <<= count;
+    }
+}
+
+
+template<typename _GF, unsigned T, unsigned N>
+struct bch_base {
+    using GF = _GF;
+    static_assert(GF::prime == 2);
+    static_assert(N <= GF::charact - 1);
+
+    static constexpr unsigned t = T;
+    static constexpr unsigned n = N;
+    static constexpr unsigned ecc = detail::bch_generator_degree<GF>(T);
+    static constexpr unsigned k = N - ecc;
+    static constexpr unsigned bytes = (N + 7) / 8;
+    static constexpr unsigned remainder_words = (ecc + 63) / 64;
+
+    static_assert(ecc < N);
+};
+
+namespace detail {
+    // Generator and minimal polynomials depend only on the field and t, keyed on the
+    // canonical field so that codes differing in length or policies share them
+    template<typename Field, unsigned T>
+    struct bch_generator_data {
+        static inline constexpr struct sdata_t {
+            using GFT = typename Field::Repr;
+            static constexpr unsigned ecc = bch_generator_degree<Field>(T);
+            static constexpr unsigned order = Field::charact - 1;
+            static constexpr unsigned words = ecc / 64 + 1;
+
+            uint64_t generator[words] = {};         // bit i of word w is the coefficient of x^(64w + i)
+            uint64_t minpoly[T] = {};               // distinct minimal polynomials, bit i = x^i
+            unsigned minpoly_degree[T] = {};
+            unsigned minpoly_count = 0;
+            uint8_t synd_minpoly[2 * T] = {};       // index of the minimal polynomial of a^(j+1)
+            static_assert(T < 256);
+
+            inline constexpr sdata_t() {
+                generator[0] = 1;
+
+                for (unsigned i = 1; i < 2 * T; i += 2) {
+                    // a^i shares the minimal polynomial of a smaller odd power if its
+                    // cyclotomic coset contains one
+                    unsigned e = i;
+                    bool fresh = true;
+                    do {
+                        fresh &= !(e < i && (e & 1));
+                        e = (e * 2) % order;
+                    } while (e != i);
+
+                    if (!fresh)
+                        continue;
+
+                    // product of (x - a^e) over the coset, lowest degree first; every a^j,
+                    // j <= 2t, in the coset has this minimal polynomial
+                    GFT poly[Field::power + 1] = {1};
+                    unsigned degree = 0;
+                    do {
+                        GFT root = Field::exp(e);
+                        for (unsigned j = degree + 1; j > 0; --j)
+                            poly[j] = Field::add(poly[j - 1], Field::mul(poly[j], root));
+                        poly[0] = Field::mul(poly[0], root);
+                        ++degree;
+
+                        if (e <= 2 * T)
+                            synd_minpoly[e - 1] = uint8_t(minpoly_count);
+                        e = (e * 2) % order;
+                    } while (e != i);
+
+                    uint64_t bits = 0;
+                    for (unsigned j = 0; j <= degree; ++j)
+                        bits |= uint64_t(poly[j] & 1) << j;
+
+                    minpoly[minpoly_count] = bits;
+                    minpoly_degree[minpoly_count] = degree;
+
+                    // generator *= minpoly over GF(2)
+                    uint64_t product[words] = {};
+                    for (unsigned j = 0; j <= degree; ++j) {
+                        if (!((bits >> j) & 1))
+                            continue;
+                        for (unsigned w = words; w-- > 0;) {
+                            uint64_t shifted = generator[w] << j;
+                            if (j && w > 0)
+                                shifted |= generator[w - 1] >> (64 - j);
+                            product[w] ^= shifted;
+                        }
+                    }
+                    for (unsigned w = 0; w < words; ++w)
+                        generator[w] = product[w];
+
+                    ++minpoly_count;
+                }
+            }
+        } sdata{};
+    };
+}
+
+template<typename BCH>
+struct bch_generator {
+    using sdata_t = typename detail::bch_generator_data<detail::gf_canonical_t<typename BCH::GF>, BCH::t>::sdata_t;
+
+    static constexpr auto& sdata = detail::bch_generator_data<detail::gf_canonical_t<typename BCH::GF>, BCH::t>::sdata;
+
+    // Generator without its leading term, aligned to the top of a 64-bit register
+    static constexpr uint64_t generator_top() {
+        static_assert(BCH::ecc <= 64);
+        return BCH::ecc < 64 ? sdata.generator[0] << (64 - BCH::ecc) : sdata.generator[0];
+    }
+};
+
+// Bit-serial remainder, one conditional xor per bit like bch/bch.c
+template<typename BCH>
+struct bch_encode_basic {
+    static_assert(BCH::ecc <= 64);
+
+    static constexpr uint64_t poly = bch_generator<BCH>::generator_top();
+
+    // (message * x^ecc) mod generator for the first `bits` bits of data, top aligned
+    static inline uint64_t remainder(const uint8_t data[], unsigned bits, uint64_t rem = 0) {
+        for (unsigned i = 0; i < bits; ++i) {
+            rem ^= uint64_t(detail::bch_bit(data, i)) << 63;
+            rem = (rem << 1) ^ (poly & (0 - (rem >> 63)));
+        }
+        return rem;
+    }
+};
+
+// Slice-by-N remainder tables, the BCH generator treated as a CRC polynomial. Reads N bytes
+// per step; N * 2 KB of tables.
+template<unsigned N>
+struct bch_encode_slice_t {
+    template<typename BCH>
+    struct type {
+        static_assert(BCH::ecc <= 64);
+        static_assert(N == 1 || N == 2 || N == 4 || N == 8);
+
+        static constexpr uint64_t poly = bch_generator<BCH>::generator_top();
+
+        static inline constexpr struct sdata_t {
+            uint64_t lut[N][256] = {};
+
+            inline constexpr sdata_t() {
+                for (unsigned b = 0; b < 256; ++b) {
+                    uint64_t rem = uint64_t(b) << 56;
+                    for (unsigned i = 0; i < 8; ++i)
+                        rem = (rem << 1) ^ (poly & (0 - (rem >> 63)));
+                    lut[0][b] = rem;
+                }
+
+                for (unsigned s = 1; s < N; ++s)
+                    for (unsigned b = 0; b < 256; ++b)
+                        lut[s][b] = (lut[s - 1][b] << 8) ^ lut[0][lut[s - 1][b] >> 56];
+            }
+        } sdata{};
+
+        static inline uint64_t remainder(const uint8_t data[], unsigned bits, uint64_t rem = 0) {
+            unsigned bytes = bits / 8;
+            unsigned i = 0;
+
+            if constexpr (N > 1) {
+                for (; bytes - i >= N; i += N) {
+                    uint64_t in = 0;
+                    for (unsigned j = 0; j < N; ++j)
+                        in = (in << 8) | data[i + j];
+
+                    rem ^= in << (64 - 8 * N) % 64;
+                    uint64_t t = N < 8 ? rem << (8 * N) % 64 : 0;
+                    for (unsigned j = 0; j < N; ++j)
+                        t ^= sdata.lut[N - 1 - j][(rem >> (56 - 8 * j)) & 0xff];
+                    rem = t;
+                }
+            }
+
+            for (; i < bytes; ++i)
+                rem = (rem << 8) ^ sdata.lut[0][(rem >> 56) ^ data[i]];
+
+            for (unsigned b = bytes * 8; b < bits; ++b) {
+                rem ^= uint64_t(detail::bch_bit(data, b)) << 63;
+                rem = (rem << 1) ^ (poly & (0 - (rem >> 63)));
+            }
+
+            return rem;
+        }
+    };
+};
+
+template<typename BCH>
+using bch_encode_slice4 = bch_encode_slice_t<4>::type<BCH>;
+template<typename BCH>
+using bch_encode_slice8 = bch_encode_slice_t<8>::type<BCH>;
+
+// Parallel LFSR for generators of any degree: Bits message bits enter the shift register per
+// step and one table lookup gives their combined feedback. The remainder is top aligned in
+// BCH::remainder_words words; 2^Bits * remainder_words * 8 bytes of table.
+template<unsigned Bits>
+struct bch_encode_lfsr_t {
+    template<typename BCH>
+    struct type {
+        static_assert(BCH::ecc > 64, "codes with ecc <= 64 use bch_encode_slice");
+        static_assert(Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8);
+
+        static constexpr unsigned words = BCH::remainder_words;
+
+        static inline constexpr struct sdata_t {
+            uint64_t poly[words] = {};              // generator without its leading term
+            uint64_t lut[1u << Bits][words] = {};
+
+            inline constexpr sdata_t() {
+                constexpr auto& gen = bch_generator<BCH>::sdata;
+                for (unsigned j = 0; j < BCH::ecc; ++j) {
+                    unsigned b = BCH::ecc - 1 - j;
+                    poly[b / 64] |= ((gen.generator[j / 64] >> (j % 64)) & 1) << (63 - b % 64);
+                }
+
+                for (unsigned v = 0; v < (1u << Bits); ++v) {
+                    uint64_t rem[words] = {uint64_t(v) << (64 - Bits)};
+                    for (unsigned i = 0; i < Bits; ++i) {
+                        uint64_t top = rem[0] >> 63;
+                        detail::bch_shift_left<words>(rem, 1);
+                        for (unsigned w = 0; w < words; ++w)
+                            rem[w] ^= poly[w] & (0 - top);
+                    }
+                    for (unsigned w = 0; w < words; ++w)
+                        lut[v][w] = rem[w];
+                }
+            }
+        } sdata{};
+
+        // (message * x^ecc) mod generator for the first `bits` bits of data, into rem
+        static inline void remainder(const uint8_t data[], unsigned bits, uint64_t rem[words]) {
+            constexpr unsigned mask = (1u << Bits) - 1;
+
+            for (unsigned i = 0; i < bits / 8; ++i) {
+                for (unsigned s = 8; s != 0; s -= Bits) {
+                    unsigned v = unsigned(rem[0] >> (64 - Bits)) ^ ((data[i] >> (s - Bits)) & mask);
+                    detail::bch_shift_left<words>(rem, Bits);
+                    for (unsigned w = 0; w < words; ++w)
+                        rem[w] ^= sdata.lut[v][w];
+                }
+            }
+
+            for (unsigned b = bits / 8 * 8; b < bits; ++b) {
+                uint64_t top = (rem[0] >> 63) ^ detail::bch_bit(data, b);
+                detail::bch_shift_left<words>(rem, 1);
+                for (unsigned w = 0; w < words; ++w)
+                    rem[w] ^= sdata.poly[w] & (0 - top);
+            }
+        }
+    };
+};
+
+template<typename BCH>
+using bch_encode_lfsr4 = bch_encode_lfsr_t<4>::type<BCH>;
+template<typename BCH>
+using bch_encode_lfsr8 = bch_encode_lfsr_t<8>::type<BCH>;
+
+// S_j = r(a^j), j = 1 .. 2t, by Horner's rule over the received bits
+template<typename BCH>
+struct bch_synds_basic {
+    using GFT = typename BCH::GF::Repr;
+
+    static inline bool synds(const uint8_t cw[], GFT synds[2 * BCH::t]) {
+        constexpr unsigned order = BCH::GF::charact - 1;
+        GFT acc = 0;
+
+        for (unsigned j = 1; j <= 2 * BCH::t; ++j) {
+            GFT x = BCH::GF::exp(j % order);
+            GFT s = 0;
+            for (unsigned i = 0; i < BCH::n; ++i)
+                s = BCH::GF::add(BCH::GF::mul(s, x), GFT(detail::bch_bit(cw, i)));
+
+            synds[j - 1] = s;
+            acc |= s;
+        }
+
+        return acc != 0;
+    }
+};
+
+// Syndromes from the remainders of the received word by each minimal polynomial m(x).
+// S_j = r(a^j) = (r mod m)(a^j) for the m that has a^j as a root, so only the short remainders
+// are evaluated, and even syndromes come from S_2j = S_j^2. The remainders are computed
+// bytewise like a CRC: rem = r(x) x^deg mod m, corrected by a^(-j deg) after evaluation.
+template<typename BCH>
+struct bch_synds_minpoly {
+    using GFT = typename BCH::GF::Repr;
+    static_assert(BCH::GF::power <= 24);
+
+    static constexpr auto& gen = bch_generator<BCH>::sdata;
+
+    static inline constexpr struct sdata_t {
+        uint32_t lut[BCH::t][256] = {};     // one bytewise remainder table per minimal polynomial
+        uint32_t poly[BCH::t] = {};         // minimal polynomials without x^deg, top aligned
+
+        inline constexpr sdata_t() {
+            for (unsigned p = 0; p < gen.minpoly_count; ++p) {
+                poly[p] = uint32_t(gen.minpoly[p] << (32 - gen.minpoly_degree[p]));
+
+                for (unsigned b = 0; b < 256; ++b) {
+                    uint32_t rem = b << 24;
+                    for (unsigned i = 0; i < 8; ++i)
+                        rem = (rem << 1) ^ (poly[p] & (0 - (rem >> 31)));
+                    lut[p][b] = rem;
+                }
+            }
+        }
+    } sdata{};
+
+    static inline bool synds(const uint8_t cw[], GFT synds[2 * BCH::t]) {
+        uint32_t rem[BCH::t] = {};
+        remainders(cw, BCH::n, rem);
+        return evaluate(rem, 0, synds);
+    }
+
+    // rem[p] = r(x) x^deg mod m_p for the first `bits` bits of data, top aligned
+    static inline void remainders(const uint8_t data[], unsigned bits, uint32_t rem[BCH::t]) {
+        constexpr unsigned count = gen.minpoly_count;
+
+        for (unsigned i = 0; i < bits / 8; ++i) {
+            for (unsigned p = 0; p < count; ++p)
+                rem[p] = (rem[p] << 8) ^ sdata.lut[p][(rem[p] >> 24) ^ data[i]];
+        }
+
+        for (unsigned b = bits / 8 * 8; b < bits; ++b) {
+            uint32_t bit = uint32_t(detail::bch_bit(data, b)) << 31;
+            for (unsigned p = 0; p < count; ++p) {
+                rem[p] ^= bit;
+                rem[p] = (rem[p] << 1) ^ (sdata.poly[p] & (0 - (rem[p] >> 31)));
+            }
+        }
+    }
+
+    // Syndromes of r(x) from the remainders of r(x) x^shift
+    static inline bool evaluate(const uint32_t rem[BCH::t], unsigned shift, GFT synds[2 * BCH::t]) {
+        constexpr unsigned order = BCH::GF::charact - 1;
+
+        uint32_t acc = 0;
+        for (unsigned p = 0; p < gen.minpoly_count; ++p)
+            acc |= rem[p];
+
+        if (acc == 0) {
+            std::fill_n(synds, 2 * BCH::t, GFT(0));
+            return false;
+        }
+
+        for (unsigned j = 1; j <= 2 * BCH::t; ++j) {
+            if (j % 2 == 0) {
+                synds[j - 1] = BCH::GF::mul(synds[j / 2 - 1], synds[j / 2 - 1]);
+                continue;
+            }
+
+            unsigned p = gen.synd_minpoly[j - 1];
+            unsigned degree = gen.minpoly_degree[p];
+            uint32_t bits = rem[p] >> (32 - degree);
+
+            GFT s = 0;
+            for (unsigned i = 0; bits; ++i, bits >>= 1) {
+                if (bits & 1)
+                    s = BCH::GF::add(s, BCH::GF::exp((j * i) % order));
+            }
+
+            unsigned e = (j * ((degree + shift) % order)) % order;
+            synds[j - 1] = s ? BCH::GF::mul(s, BCH::GF::exp((order - e) % order)) : 0;
+        }
+
+        return true;
+    }
+};
+
+// Syndromes for long codes: the received word is first reduced modulo the generator by a
+// bytewise LFSR, which settles clean words on its own, and only the ecc-bit remainder
+// (r(x) x^ecc mod g, with the same roots as r) goes through the tables of bch_synds_minpoly.
+template<typename BCH>
+struct bch_synds_remainder {
+    using GFT = typename BCH::GF::Repr;
+    using reduce = std::conditional_t<(BCH::ecc <= 64), bch_encode_slice8<BCH>, bch_encode_lfsr8<BCH>>;
+    static constexpr unsigned words = BCH::remainder_words;
+
+    static inline bool synds(const uint8_t cw[], GFT synds[2 * BCH::t]) {
+        uint64_t rem[words] = {};
+        if constexpr (BCH::ecc <= 64)
+            rem[0] = reduce::remainder(cw, BCH::n);
+        else
+            reduce::remainder(cw, BCH::n, rem);
+
+        uint64_t acc = 0;
+        for (auto r : rem)
+            acc |= r;
+
+        if (acc == 0) {
+            std::fill_n(synds, 2 * BCH::t, GFT(0));
+            return false;
+        }
+
+        uint8_t bytes[words * 8];
+        for (unsigned i = 0; i < words * 8; ++i)
+            bytes[i] = uint8_t(rem[i / 8] >> (56 - 8 * (i % 8)));
+
+        uint32_t mrem[BCH::t] = {};
+        bch_synds_minpoly<BCH>::remainders(bytes, BCH::ecc, mrem);
+        return bch_synds_minpoly<BCH>::evaluate(mrem, BCH::ecc, synds);
+    }
+};
+
+namespace detail {
+    typedef uint64_t u64x1 __attribute__((vector_size(8)));
+    typedef uint64_t u64x2 __attribute__((vector_size(16)));
+    typedef uint64_t u64x4 __attribute__((vector_size(32)));
+    typedef uint64_t u64x8 __attribute__((vector_size(64)));
+
+    template<unsigned Lanes>
+    using u64xn = std::conditional_t<Lanes == 1, u64x1, std::conditional_t<Lanes == 2, u64x2,
+            std::conditional_t<Lanes == 4, u64x4, u64x8>>>;
+}
+
+// Chien search over the N codeword positions, roots returned as bit indices
+template<typename BCH>
+struct bch_roots_chien {
+    using GFT = typename BCH::GF::Repr;
+
+    // locator is lowest degree first, locator[0] == 1
+    static inline unsigned roots(const GFT locator[], unsigned degree, unsigned positions[]) {
+        constexpr unsigned order = BCH::GF::charact - 1;
+
+        GFT term[BCH::t + 1] = {};
+        GFT step[BCH::t + 1] = {};
+        for (unsigned j = 1; j <= degree; ++j) {
+            term[j] = locator[j];
+            step[j] = BCH::GF::exp((order - j % order) % order);
+        }
+
+        unsigned count = 0;
+        for (unsigned i = 0; i < BCH::n; ++i) {
+            GFT sum = 1;
+            for (unsigned j = 1; j <= degree; ++j) {
+                sum = BCH::GF::add(sum, term[j]);
+                term[j] = BCH::GF::mul(term[j], step[j]);
+            }
+
+            if (sum == 0) {
+                if (count == degree)
+                    return degree + 1;
+                positions[count++] = BCH::n - 1 - i;
+            }
+        }
+
+        return count;
+    }
+};
+
+// Chien search over blocks of 64 * Lanes positions at a time, bitsliced: bit l of plane q
+// holds bit q of the locator value at offset l of the block. With c_j = L_j a^(-j i0) for the
+// block at i0, the sum over the block is sum_j c_j W_j, where the planes of W_j = a^(-j l) are
+// constant. Splitting c_j into its bits b turns that into sum_b a^b U_b, U_b the XOR of the
+// W_j whose c_j has bit b set. The XORs of every subset of four consecutive W_j are tabulated,
+// so U_b takes t/4 lookups of m planes, and the sum over b is Horner's rule on planes.
+// (t/4) * 16 * m * Lanes * 8 bytes of tables.
+template<unsigned Lanes>
+struct bch_roots_bitslice_t {
+    template<typename BCH>
+    struct type {
+        using GFT = typename BCH::GF::Repr;
+        using vec = detail::u64xn<Lanes>;
+        static_assert(Lanes == 1 || Lanes == 2 || Lanes == 4 || Lanes == 8);
+        static_assert(BCH::GF::power <= 16);
+
+        static constexpr unsigned m = BCH::GF::power;
+        static constexpr unsigned order = BCH::GF::charact - 1;
+        static constexpr unsigned group = 64 * Lanes;
+        static constexpr unsigned chunks = (BCH::t + 3) / 4;
+
+        static inline constexpr struct sdata_t {
+            uint64_t subsets[chunks][16][m][Lanes] = {};    // XORs of the planes of a^(-j l)
+            GFT step[4 * chunks] = {};                      // a^(-j group), j = 1 .. t
+            uint32_t spread[256] = {};                      // bit b to bit 4b
+            GFT taps = 0;                                   // a^m, the reduction of the top plane
+
+            inline constexpr sdata_t() {
+                for (unsigned j = 1; j <= BCH::t; ++j) {
+                    unsigned chunk = (j - 1) / 4, bit = 1u << ((j - 1) % 4);
+                    uint64_t planes[m][Lanes] = {};
+                    for (unsigned l = 0, e = 0; l < group; ++l, e = e >= j ? e - j : e + order - j) {
+                        GFT v = BCH::GF::exp(e);
+                        for (unsigned q = 0; q < m; ++q)
+                            planes[q][l / 64] |= uint64_t((v >> q) & 1) << (l % 64);
+                    }
+
+                    for (unsigned s = bit; s < 16; s = (s + 1) | bit)
+                        for (unsigned q = 0; q < m; ++q)
+                            for (unsigned w = 0; w < Lanes; ++w)
+                                subsets[chunk][s][q][w] ^= planes[q][w];
+                    step[j - 1] = BCH::GF::exp((order - (j * group) % order) % order);
+                }
+
+                for (unsigned v = 0; v < 256; ++v)
+                    for (unsigned b = 0; b < 8; ++b)
+                        spread[v] |= ((v >> b) & 1u) << (4 * b);
+                taps = BCH::GF::exp(m);
+            }
+        } sdata{};
+
+        // locator is lowest degree first, locator[0] == 1
+        static inline unsigned roots(const GFT locator[], unsigned degree, unsigned positions[]) {
+            GFT c[4 * chunks] = {};
+            std::copy_n(locator + 1, degree, c);
+            const unsigned used = (degree + 3) / 4;
+
+            unsigned count = 0;
+            for (unsigned base = 0; base < BCH::n; base += group) {
+                // bit 4b + i of index[k] is bit b of c_(4k+i+1)
+                uint64_t index[chunks];
+                for (unsigned k = 0; k < used; ++k) {
+                    index[k] = 0;
+                    for (unsigned i = 0; i < 4; ++i) {
+                        GFT x = c[4 * k + i];
+                        index[k] |= (uint64_t(sdata.spread[x & 0xff]) | uint64_t(sdata.spread[x >> 8]) << 32) << i;
+                        c[4 * k + i] = BCH::GF::mul(x, sdata.step[4 * k + i]);
+                    }
+                }
+
+                // Horner's rule in a over the U_b; multiplying planes by a moves plane q to
+                // q + 1 and feeds the top plane back through the taps
+                vec v[m] = {};
+                for (unsigned b = m; b-- > 0;) {
+                    vec top = v[m - 1];
+                    for (unsigned q = m - 1; q > 0; --q)
+                        v[q] = v[q - 1] ^ ((sdata.taps >> q) & 1 ? top : vec{});
+                    v[0] = (sdata.taps & 1) ? top : vec{};
+
+                    for (unsigned k = 0; k < used; ++k) {
+                        auto& planes = sdata.subsets[k][(index[k] >> (4 * b)) & 15];
+                        for (unsigned q = 0; q < m; ++q) {
+                            vec w;
+                            std::memcpy(&w, planes[q], sizeof(w));
+                            v[q] ^= w;
+                        }
+                    }
+                }
+
+                vec nonzero = ~v[0];        // + L_0 == 1
+                for (unsigned q = 1; q < m; ++q)
+                    nonzero |= v[q];
+
+                for (unsigned l = 0; l < Lanes && base + 64 * l < BCH::n; ++l) {
+                    unsigned left = BCH::n - base - 64 * l;
+                    uint64_t zeros = ~nonzero[l];
+                    if (left < 64)
+                        zeros &= (uint64_t(1) << left) - 1;
+
+                    for (; zeros; zeros &= zeros - 1) {
+                        if (count == degree)
+                            return degree + 1;
+                        unsigned i = base + 64 * l + unsigned(__builtin_ctzll(zeros));
+                        positions[count++] = BCH::n - 1 - i;
+                    }
+                }
+            }
+
+            return count;
+        }
+    };
+};
+
+template<typename BCH>
+using bch_roots_bitslice128 = bch_roots_bitslice_t<2>::type<BCH>;
+template<typename BCH>
+using bch_roots_bitslice256 = bch_roots_bitslice_t<4>::type<BCH>;
+
+template<unsigned T>
+struct bch_decode_result {
+    enum status_t : uint8_t {
+        ok = 0,
+        too_many_errors,    // locator degree exceeds t
+        roots_mismatch,     // locator does not split into distinct roots inside the codeword
+        status_count
+    };
+
+    status_t status = ok;
+    unsigned corrected = 0;         // bits that were flipped
+    unsigned positions[T] = {};     // bit indices of the flipped bits
+
+    explicit inline constexpr operator bool() const { return status == ok; }
+};
+
+template<typename BCH>
+struct bch_decode {
+    using GFT = typename BCH::GF::Repr;
+    using result = bch_decode_result<BCH::t>;
+
+    static inline result decode(uint8_t cw[]) {
+        GFT synds[2 * BCH::t];
+        if (!BCH::synds(cw, synds))
+            return {};
+
+        return correct(cw, synds);
+    }
+
+    // Locates and flips the error bits of a codeword with nonzero syndromes
+    static inline result correct(uint8_t cw[], const GFT synds[2 * BCH::t]) {
+        result r;
+
+        GFT locator[2 * BCH::t + 1];
+        unsigned degree = berlekamp_massey(synds, locator);
+        if (degree > BCH::t) {
+            r.status = result::too_many_errors;
+            return r;
+        }
+
+        if (BCH::roots(locator, degree, r.positions) != degree) {
+            r.status = result::roots_mismatch;
+            return r;
+        }
+
+        for (unsigned i = 0; i < degree; ++i)
+            cw[r.positions[i] / 8] ^= uint8_t(0x80 >> (r.positions[i] % 8));
+
+        r.corrected = degree;
+        return r;
+    }
+
+    // Error locator, lowest degree first; returns its degree
+    static inline unsigned berlekamp_massey(const GFT synds[2 * BCH::t], GFT locator[2 * BCH::t + 1]) {
+        constexpr unsigned size = 2 * BCH::t + 1;
+
+        GFT prev[size] = {1};
+        std::fill_n(locator, size, GFT(0));
+        locator[0] = 1;
+
+        unsigned degree = 0;
+        unsigned m = 1;
+        GFT b = 1;
+
+        for (unsigned n = 0; n < 2 * BCH::t; ++n) {
+            GFT d = synds[n];
+            for (unsigned i = 1; i <= degree; ++i)
+                d = BCH::GF::add(d, BCH::GF::mul(locator[i], synds[n - i]));
+
+            if (d == 0) {
+                ++m;
+                continue;
+            }
+
+            GFT coef = BCH::GF::div(d, b);
+
+            if (2 * degree <= n) {
+                GFT temp[size];
+                std::copy_n(locator, size, temp);
+
+                for (unsigned i = 0; i + m < size; ++i)
+                    locator[i + m] = BCH::GF::add(locator[i + m], BCH::GF::mul(coef, prev[i]));
+
+                degree = n + 1 - degree;
+                std::copy_n(temp, size, prev);
+                b = d;
+                m = 1;
+            } else {
+                for (unsigned i = 0; i + m < size; ++i)
+                    locator[i + m] = BCH::GF::add(locator[i + m], BCH::GF::mul(coef, prev[i]));
+                ++m;
+            }
+        }
+
+        return degree;
+    }
+};
+
+// Batch decoding of codewords of up to 64 bits stored as 8-byte frames. Each group of
+// 64 * Lanes frames is transposed into bit-planes, so that bit w of plane i is bit i of
+// frame w. The odd syndromes are then XOR sums of planes, computed for every frame of the
+// group at once with GCC vector extensions; frames with all-zero syndromes are clean and
+// are never touched again. Only the dirty frames go through bch_decode (Berlekamp-Massey
+// and the roots policy).
+template<unsigned Lanes>
+struct bch_batch_t {
+    template<typename BCH>
+    struct type {
+        using GFT = typename BCH::GF::Repr;
+        static_assert(BCH::n <= 64);
+        static_assert(Lanes == 1 || Lanes == 2 || Lanes == 4 || Lanes == 8);
+
+        using vec = detail::u64xn<Lanes>;
+
+        static constexpr unsigned frame = 8;
+        static constexpr unsigned group = 64 * Lanes;
+        static constexpr unsigned odd = BCH::t;         // S_1, S_3, .., S_(2t-1)
+
+        static inline constexpr struct sdata_t {
+            // bits of a^(j (n-1-i)), the weight of codeword bit i in S_j, j = 2o+1
+            GFT weight[BCH::n][odd] = {};
+
+            inline constexpr sdata_t() {
+                constexpr unsigned order = BCH::GF::charact - 1;
+                for (unsigned i = 0; i < BCH::n; ++i)
+                    for (unsigned o = 0; o < odd; ++o)
+                        weight[i][o] = BCH::GF::exp(((2 * o + 1) * (BCH::n - 1 - i)) % order);
+            }
+        } sdata{};
+
+        // Decodes count frames in place; returns the number that could not be decoded
+        static inline size_t decode_batch(uint8_t frames[], size_t count,
+                bch_decode_result<BCH::t> results[] = nullptr) {
+            size_t failed = 0;
+
+            for (size_t base = 0; base < count; base += group) {
+                size_t size = std::min<size_t>(group, count - base);
+
+                vec planes[64];
+                for (unsigned l = 0; l < Lanes; ++l) {
+                    uint64_t rows[64] = {};
+                    for (unsigned w = 0; w < 64 && l * 64 + w < size; ++w)
+                        rows[w] = detail::load_be64(&frames[(base + l * 64 + w) * frame]);
+
+                    detail::transpose64(rows);
+                    for (unsigned i = 0; i < 64; ++i)
+                        planes[i][l] = rows[i];
+                }
+
+                vec synds[odd][BCH::GF::power] = {};
+                for (unsigned i = 0; i < BCH::n; ++i) {
+                    for (unsigned o = 0; o < odd; ++o) {
+                        for (GFT w = sdata.weight[i][o]; w; w &= w - 1)
+                            synds[o][__builtin_ctz(w)] ^= planes[i];
+                    }
+                }
+
+                vec dirty = {};
+                for (unsigned o = 0; o < odd; ++o)
+                    for (unsigned q = 0; q < BCH::GF::power; ++q)
+                        dirty |= synds[o][q];
+
+                if (results) {
+                    for (size_t w = 0; w < size; ++w)
+                        results[base + w] = {};
+                }
+
+                for (unsigned l = 0; l < Lanes; ++l) {
+                    for (uint64_t mask = dirty[l]; mask; mask &= mask - 1) {
+                        unsigned bit = unsigned(__builtin_ctzll(mask));
+                        size_t idx = base + l * 64 + (63 - bit);
+
+                        GFT s[2 * BCH::t];
+                        for (unsigned o = 0; o < odd; ++o) {
+                            GFT v = 0;
+                            for (unsigned q = 0; q < BCH::GF::power; ++q)
+                                v |= GFT(((synds[o][q][l] >> bit) & 1) << q);
+                            s[2 * o] = v;
+                        }
+                        for (unsigned j = 2; j <= 2 * BCH::t; j += 2)
+                            s[j - 1] = BCH::GF::mul(s[j / 2 - 1], s[j / 2 - 1]);
+
+                        auto r = bch_decode<BCH>::correct(&frames[idx * frame], s);
+                        failed += !r;
+                        if (results)
+                            results[idx] = r;
+                    }
+                }
+            }
+
+            return failed;
+        }
+    };
+};
+
+template<typename BCH>
+using bch_batch64 = bch_batch_t<1>::type<BCH>;
+template<typename BCH>
+using bch_batch256 = bch_batch_t<4>::type<BCH>;
+
+template<typename GF, unsigned T, unsigned N, template<class>typename...Fs>
+struct bch_impl_base : bch_base<GF, T, N>, Fs<bch_base<GF, T, N>>... { };
+
+template<typename Impl, template<class>typename...Fs>
+struct bch_impl : bch_base<typename Impl::GF, Impl::t, Impl::n>, Fs<Impl>... {
+    static inline auto static_data_size = detail::get_sdata_size<bch_generator<Impl>, Fs<Impl>...>();
+
+    using sdata_policies = typename Impl::GF::sdata_policies::template append<bch_generator<Impl>, Fs<Impl>...>;
+
+    // Writes the parity after the first K bits of cw
+    static inline void encode(uint8_t cw[]) {
+        if constexpr (Impl::ecc <= 64) {
+            detail::bch_put_bits(cw, Impl::k, bch_impl::remainder(cw, Impl::k), Impl::ecc);
+        } else {
+            uint64_t rem[Impl::remainder_words] = {};
+            bch_impl::remainder(cw, Impl::k, rem);
+            for (unsigned w = 0; w < Impl::remainder_words; ++w)
+                detail::bch_put_bits(cw, Impl::k + 64 * w, rem[w], std::min(64u, Impl::ecc - 64 * w));
+        }
+    }
+
+    // Remainder of the whole codeword, zero for a valid one
+    static inline uint64_t check_remainder(const uint8_t cw[]) {
+        return bch_impl::remainder(cw, Impl::n);
+    }
+
+    static inline bool check(const uint8_t cw[]) {
+        if constexpr (Impl::ecc <= 64) {
+            return check_remainder(cw) == 0;
+        } else {
+            uint64_t rem[Impl::remainder_words] = {};
+            bch_impl::remainder(cw, Impl::n, rem);
+
+            uint64_t acc = 0;
+            for (auto r : rem)
+                acc |= r;
+            return acc == 0;
+        }
+    }
+};
+
+template<typename GF, unsigned T, unsigned N, template<class>typename...Fs>
+struct BCH : bch_impl<bch_impl_base<GF, T, N, Fs...>, Fs...> { };
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "reed_solomon.hpp"
+
+// Throughput and latency measurement for RS policy packs.
+//
+// Every case works on a pregenerated corpus of encoded codewords and of damaged copies, so
+// no random numbers are drawn while timing. Codewords are timed in batches with a single
+// pair of clock reads; per-codeword latency percentiles are taken over the batch averages.
+
+namespace bench {
+    using clock = std::chrono::steady_clock;
+
+    struct options {
+        double seconds = 0.05;      // per case
+        unsigned batch = 32;        // codewords per clock read
+        unsigned corpus = 1024;     // pregenerated codewords per case
+        std::string filter;         // substring of the case name
+    };
+
+    struct record {
+        std::string codec;
+        std::string op;
+        unsigned ecc = 0;
+        unsigned msglen = 0;
+        unsigned errors = 0;
+        uint64_t codewords = 0;
+        uint64_t failures = 0;
+        double mb_s = 0;
+        double ns_per_codeword = 0;
+        double p50_ns = 0;
+        double p99_ns = 0;
+        double p999_ns = 0;
+        double baseline_mb_s = 0;   // 0 if there is no matching baseline entry
+
+        inline std::string key() const {
+            std::ostringstream s;
+            s << codec << ',' << op << ',' << ecc << ',' << msglen << ',' << errors;
+            return s.str();
+        }
+    };
+
+    template<typename RS>
+    struct corpus {
+        using GFT = typename RS::GF::Repr;
+
+        unsigned msglen;
+        unsigned count;
+        std::vector<GFT> clean;
+        std::vector<GFT> damaged;
+
+        corpus(unsigned msglen, unsigned count, unsigned errors, uint64_t seed)
+                : msglen(msglen), count(count), clean(size_t(count) * n()), damaged() {
+            std::mt19937_64 rng(seed);
+
+            for (unsigned k = 0; k < count; ++k) {
+                auto cw = &clean[size_t(k) * n()];
+                for (unsigned i = 0; i < msglen; ++i)
+                    cw[i] = GFT(rng() % RS::GF::charact);
+                RS::encode(cw + msglen, cw, msglen);
+            }
+
+            damaged = clean;
+            std::vector<unsigned> pos(n());
+            for (unsigned k = 0; k < count; ++k) {
+                std::iota(pos.begin(), pos.end(), 0);
+                std::shuffle(pos.begin(), pos.end(), rng);
+
+                auto cw = &damaged[size_t(k) * n()];
+                for (unsigned i = 0; i < errors; ++i)
+                    cw[pos[i]] = RS::GF::add(cw[pos[i]], GFT(1 + rng() % (RS::GF::charact - 1)));
+            }
+        }
+
+        inline unsigned n() const { return msglen + RS::ecc; }
+    };
+
+    namespace detail {
+        static inline double percentile(std::vector<double>& v, double p) {
+            if (v.empty())
+                return 0;
+            auto k = std::min(v.size() - 1, size_t(p * double(v.size())));
+            std::nth_element(v.begin(), v.begin() + k, v.end());
+            return v[k];
+        }
+
+        static inline bool selected(options const& opt, std::string const& name) {
+            return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+        }
+
+        // Calls prepare(first, count) untimed, then step(first, count) timed, until time is up
+        template<typename P, typename S>
+        static inline void measure(options const& opt, unsigned corpus_size, unsigned msg_bytes,
+                record& r, P&& prepare, S&& step) {
+            std::vector<double> samples;
+            double total_ns = 0;
+            unsigned first = 0;
+
+            auto deadline = clock::now() + std::chrono::duration<double>(opt.seconds);
+            do {
+                unsigned count = std::min(opt.batch, corpus_size - first);
+                prepare(first, count);
+
+                auto t0 = clock::now();
+                step(first, count);
+                auto t1 = clock::now();
+
+                double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+                total_ns += ns;
+                samples.push_back(ns / count);
+                r.codewords += count;
+
+                first = (first + count) % corpus_size;
+            } while (clock::now() < deadline);
+
+            r.ns_per_codeword = total_ns / double(r.codewords);
+            r.mb_s = double(r.codewords) * msg_bytes / total_ns * 1e3;
+            r.p50_ns = percentile(samples, 0.5);
+            r.p99_ns = percentile(samples, 0.99);
+            r.p999_ns = percentile(samples, 0.999);
+        }
+    }
+
+    template<typename RS>
+    inline void run_encode(std::vector<record>& out, options const& opt, std::string const& codec, unsigned msglen) {
+        if (!detail::selected(opt, codec + " encode"))
+            return;
+
+        corpus<RS> c(msglen, opt.corpus, 0, 42);
+        auto work = c.clean;
+
+        record r;
+        r.codec = codec;
+        r.op = "encode";
+        r.ecc = RS::ecc;
+        r.msglen = msglen;
+
+        detail::measure(opt, c.count, msglen * sizeof(typename RS::GF::Repr), r,
+                [](unsigned, unsigned) { },
+                [&](unsigned first, unsigned count) {
+                    for (unsigned k = first; k < first + count; ++k) {
+                        auto cw = &work[size_t(k) * c.n()];
+                        RS::encode(cw + msglen, cw, msglen);
+                    }
+                });
+
+        r.failures = (work != c.clean);
+        out.push_back(r);
+    }
+
+    template<typename RS>
+    inline void run_decode(std::vector<record>& out, options const& opt, std::string const& codec,
+            unsigned msglen, unsigned errors) {
+        if (!detail::selected(opt, codec + " decode"))
+            return;
+
+        corpus<RS> c(msglen, opt.corpus, errors, 42 + errors);
+        auto work = c.damaged;
+
+        record r;
+        r.codec = codec;
+        r.op = "decode";
+        r.ecc = RS::ecc;
+        r.msglen = msglen;
+        r.errors = errors;
+
+        detail::measure(opt, c.count, msglen * sizeof(typename RS::GF::Repr), r,
+                [&](unsigned first, unsigned count) {
+                    std::copy_n(&c.damaged[size_t(first) * c.n()], size_t(count) * c.n(), &work[size_t(first) * c.n()]);
+                },
+                [&](unsigned first, unsigned count) {
+                    for (unsigned k = first; k < first + count; ++k) {
+                        auto cw = &work[size_t(k) * c.n()];
+                        RS::decode(cw, msglen, cw + msglen);
+                    }
+                });
+
+        // every codeword decoded so far holds the result of its latest decode
+        auto decoded = unsigned(std::min<uint64_t>(r.codewords, c.count));
+        for (unsigned k = 0; k < decoded; ++k) {
+            auto begin = size_t(k) * c.n();
+            r.failures += !std::equal(&work[begin], &work[begin + c.n()], &c.clean[begin]);
+        }
+
+        out.push_back(r);
+    }
+
+    // Reads a CSV written by write_csv and fills in baseline_mb_s for matching cases
+    inline bool apply_baseline(std::vector<record>& records, std::string const& path) {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+
+        std::map<std::string, double> baseline;
+        std::string line;
+        std::getline(in, line);
+
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields;
+            std::istringstream s(line);
+            for (std::string f; std::getline(s, f, ',');)
+                fields.push_back(f);
+
+            if (fields.size() < 9)
+                continue;
+
+            baseline[fields[0] + ',' + fields[1] + ',' + fields[2] + ',' + fields[3] + ',' + fields[4]] =
+                    std::stod(fields[8]);
+        }
+
+        for (auto& r : records) {
+            auto it = baseline.find(r.key());
+            if (it != baseline.end())
+                r.baseline_mb_s = it->second;
+        }
+
+        return true;
+    }
+
+    inline void write_csv(std::FILE *f, std::vector<record> const& records) {
+        std::fprintf(f, "codec,op,ecc,msglen,errors,codewords,failures,ns_per_codeword,mb_s,p50_ns,p99_ns,p999_ns,"
+                "baseline_mb_s,speedup\n");
+
+        for (auto& r : records) {
+            std::fprintf(f, "%s,%s,%u,%u,%u,%llu,%llu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.3f\n",
+                    r.codec.c_str(), r.op.c_str(), r.ecc, r.msglen, r.errors,
+                    (unsigned long long) r.codewords, (unsigned long long) r.failures,
+                    r.ns_per_codeword, r.mb_s, r.p50_ns, r.p99_ns, r.p999_ns,
+                    r.baseline_mb_s, r.baseline_mb_s > 0 ? r.mb_s / r.baseline_mb_s : 0.0);
+        }
+    }
+
+    inline void write_json(std::FILE *f, std::vector<record> const& records) {
+        std::fprintf(f, "[\n");
+
+        for (size_t i = 0; i < records.size(); ++i) {
+            auto& r = records[i];
+            std::fprintf(f, "  {\"codec\": \"%s\", \"op\": \"%s\", \"ecc\": %u, \"msglen\": %u, \"errors\": %u, "
+                    "\"codewords\": %llu, \"failures\": %llu, \"ns_per_codeword\": %.2f, \"mb_s\": %.2f, "
+                    "\"p50_ns\": %.2f, \"p99_ns\": %.2f, \"p999_ns\": %.2f",
+                    r.codec.c_str(), r.op.c_str(), r.ecc, r.msglen, r.errors,
+                    (unsigned long long) r.codewords, (unsigned long long) r.failures,
+                    r.ns_per_codeword, r.mb_s, r.p50_ns, r.p99_ns, r.p999_ns);
+
+            if (r.baseline_mb_s > 0)
+                std::fprintf(f, ", \"baseline_mb_s\": %.2f, \"speedup\": %.3f", r.baseline_mb_s, r.mb_s / r.baseline_mb_s);
+
+            std::fprintf(f, "}%s\n", i + 1 < records.size() ? "," : "");
+        }
+
+        std::fprintf(f, "]\n");
+    }
+
+    inline void write_text(std::FILE *f, std::vector<record> const& records) {
+        std::fprintf(f, "%-28s %-6s %4s %6s %6s %10s %10s %10s %10s %10s %8s\n",
+                "codec", "op", "ecc", "msglen", "errors", "MB/s", "ns/cw", "p50 ns", "p99 ns", "p999 ns", "speedup");
+
+        for (auto& r : records) {
+            std::fprintf(f, "%-28s %-6s %4u %6u %6u %10.2f %10.1f %10.1f %10.1f %10.1f",
+                    r.codec.c_str(), r.op.c_str(), r.ecc, r.msglen, r.errors,
+                    r.mb_s, r.ns_per_codeword, r.p50_ns, r.p99_ns, r.p999_ns);
+
+            if (r.baseline_mb_s > 0)
+                std::fprintf(f, " %7.3fx", r.mb_s / r.baseline_mb_s);
+            if (r.failures)
+                std::fprintf(f, "  FAILED x%llu", (unsigned long long) r.failures);
+
+            std::fprintf(f, "\n");
+        }
+    }
+}
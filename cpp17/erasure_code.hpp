@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "galois.hpp"
+
+// Systematic K+M erasure code over GF(2^n) for striping across fragments: K data fragments
+// of equal length produce M parity fragments, and any K of the K+M rebuild the rest.
+// The parity rows form a Cauchy matrix 1/(x_i + y_j) with x_i = K+i and y_j = j, so every
+// square submatrix is invertible and the code is MDS. Fragments are processed column-wise,
+// one region multiply-accumulate per matrix coefficient, several symbols per machine word.
+template<typename GF, unsigned K, unsigned M>
+struct erasure_code {
+    using GFT = typename GF::Repr;
+
+    static_assert(GF::prime == 2);
+    static_assert(K > 0 && M > 0 && K + M <= GF::charact);
+
+    static constexpr unsigned k = K;
+    static constexpr unsigned m = M;
+
+    static inline constexpr struct sdata_t {
+        GFT parity[M][K] = {};
+
+        constexpr inline sdata_t() {
+            for (unsigned i = 0; i < M; ++i)
+                for (unsigned j = 0; j < K; ++j)
+                    parity[i][j] = GF::inv(GFT(K + i) ^ GFT(j));
+        }
+    } sdata{};
+
+    // dst[i] += c * src[i]
+    //
+    // Multiplication by c is linear over GF(2), so c * s is the sum of c * x^b over the set bits
+    // b of s. The bulk of the region goes through 64-bit words holding several symbols: each bit
+    // plane is spread to a lane mask and selects the matching product. There are no table loads,
+    // so the loop vectorizes; the scalar loop only handles the tail.
+    static inline void region_mul_add(GFT *dst, const GFT *src, GFT c, size_t len) {
+        if (c == 0)
+            return;
+
+        if (c == 1) {
+            for (size_t i = 0; i < len; ++i)
+                dst[i] ^= src[i];
+            return;
+        }
+
+        using Word = uint64_t;
+        constexpr unsigned lane = 8 * sizeof(GFT);
+        constexpr size_t per_word = sizeof(Word) / sizeof(GFT);
+        constexpr Word ones = ~Word(0) / ((Word(1) << lane) - 1);      // 1 in the low bit of every lane
+
+        Word planes[GF::power];
+        for (unsigned b = 0; b < GF::power; ++b)
+            planes[b] = ones * GF::mul(c, GFT(1u << b));
+
+        const size_t words = len / per_word;
+        for (size_t i = 0; i < words; ++i) {
+            Word s, d, r = 0;
+            std::memcpy(&s, &src[i * per_word], sizeof(Word));
+
+            for (unsigned b = 0; b < GF::power; ++b) {
+                Word m = (s >> b) & ones;
+                r ^= ((m << lane) - m) & planes[b];
+            }
+
+            std::memcpy(&d, &dst[i * per_word], sizeof(Word));
+            d ^= r;
+            std::memcpy(&dst[i * per_word], &d, sizeof(Word));
+        }
+
+        for (size_t i = words * per_word; i < len; ++i)
+            dst[i] ^= GF::mul(c, src[i]);
+    }
+
+    static inline void encode(const GFT *const data[], GFT *const parity[], size_t len) {
+        for (unsigned i = 0; i < M; ++i) {
+            std::fill_n(parity[i], len, GFT(0));
+            for (unsigned j = 0; j < K; ++j)
+                region_mul_add(parity[i], data[j], sdata.parity[i][j], len);
+        }
+    }
+
+    // frags holds K data then M parity fragments; the `count` fragments listed in `erased`
+    // are rebuilt in place from the others. Returns false if more than M are missing.
+    static inline bool reconstruct(GFT *const frags[], const unsigned erased[], unsigned count, size_t len) {
+        if (count > M)
+            return false;
+
+        bool missing[K + M] = {};
+        for (unsigned i = 0; i < count; ++i) {
+            if (erased[i] >= K + M)
+                return false;
+            missing[erased[i]] = true;
+        }
+
+        unsigned rows[K];
+        for (unsigned i = 0, n = 0; n < K; ++i) {
+            if (!missing[i])
+                rows[n++] = i;
+        }
+
+        bool data_missing = std::any_of(&missing[0], &missing[K], [](bool b) { return b; });
+
+        if (data_missing) {
+            GFT inverse[K][K];
+            if (!invert(rows, inverse))
+                return false;
+
+            for (unsigned j = 0; j < K; ++j) {
+                if (!missing[j])
+                    continue;
+
+                std::fill_n(frags[j], len, GFT(0));
+                for (unsigned t = 0; t < K; ++t)
+                    region_mul_add(frags[j], frags[rows[t]], inverse[j][t], len);
+            }
+        }
+
+        for (unsigned i = 0; i < M; ++i) {
+            if (!missing[K + i])
+                continue;
+
+            std::fill_n(frags[K + i], len, GFT(0));
+            for (unsigned j = 0; j < K; ++j)
+                region_mul_add(frags[K + i], frags[j], sdata.parity[i][j], len);
+        }
+
+        return true;
+    }
+
+    // Inverts the K x K submatrix of the generator [I; C] made of the given rows.
+    static inline bool invert(const unsigned rows[], GFT inverse[][K]) {
+        GFT a[K][K];
+
+        for (unsigned r = 0; r < K; ++r) {
+            for (unsigned c = 0; c < K; ++c) {
+                a[r][c] = rows[r] < K ? GFT(rows[r] == c) : sdata.parity[rows[r] - K][c];
+                inverse[r][c] = GFT(r == c);
+            }
+        }
+
+        for (unsigned c = 0; c < K; ++c) {
+            unsigned p = c;
+            while (p < K && a[p][c] == 0)
+                ++p;
+            if (p == K)
+                return false;
+
+            if (p != c) {
+                std::swap_ranges(&a[p][0], &a[p][K], &a[c][0]);
+                std::swap_ranges(&inverse[p][0], &inverse[p][K], &inverse[c][0]);
+            }
+
+            GFT norm = GF::inv(a[c][c]);
+            for (unsigned j = 0; j < K; ++j) {
+                a[c][j] = GF::mul(a[c][j], norm);
+                inverse[c][j] = GF::mul(inverse[c][j], norm);
+            }
+
+            for (unsigned r = 0; r < K; ++r) {
+                GFT f = a[r][c];
+                if (r == c || f == 0)
+                    continue;
+
+                for (unsigned j = 0; j < K; ++j) {
+                    a[r][j] ^= GF::mul(f, a[c][j]);
+                    inverse[r][j] ^= GF::mul(f, inverse[c][j]);
+                }
+            }
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parallel.hpp"
+#include "reed_solomon.hpp"
+
+// Sidecar parity files for GF(2^8) Reed-Solomon codes.
+//
+// The protected file is split into stripes of interleave * data_len bytes. Codeword j of a
+// stripe takes every interleave-th byte starting at j, so a burst of up to
+// interleave * ecc / 2 bytes is spread over many codewords. The sidecar holds a header
+// followed by the parity of each codeword, stripe by stripe; the final stripe is padded
+// with virtual zero bytes. The source file is never rewritten except by repair, which
+// only touches the symbols that were corrected.
+
+using rs_file_gf = GF<uint8_t, 2, 8, 2, 0x11d & 0xff, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+
+struct rs_file_header {
+    static constexpr char magic_value[8] = {'F', 'F', 'R', 'S', 'P', 'A', 'R', '1'};
+    static constexpr uint32_t version_value = 1;
+    static constexpr unsigned max_interleave = 256;
+
+    // fields are stored in host byte order
+    char magic[8];
+    uint32_t version;
+    uint32_t field_power;
+    uint32_t field_poly;
+    uint32_t ecc;
+    uint32_t data_len;
+    uint32_t interleave;
+    uint64_t file_size;
+    uint64_t stripes;
+    uint64_t reserved;
+    uint64_t checksum;      // FNV-1a over everything above
+
+    inline uint64_t compute_checksum() const {
+        uint64_t h = 0xcbf29ce484222325;
+        auto p = reinterpret_cast<const uint8_t *>(this);
+        for (unsigned i = 0; i < offsetof(rs_file_header, checksum); ++i)
+            h = (h ^ p[i]) * 0x100000001b3;
+        return h;
+    }
+
+    inline uint64_t stripe_len() const { return uint64_t(interleave) * data_len; }
+    inline uint64_t parity_size() const { return sizeof(rs_file_header) + stripes * interleave * ecc; }
+};
+
+static_assert(sizeof(rs_file_header) == 64);
+
+enum class rs_file_status {
+    ok = 0,
+    io_error,           // file could not be opened, sized or mapped
+    bad_header,         // sidecar is not a parity file or is damaged
+    unsupported,        // parameters outside the compiled set
+    size_mismatch,      // protected file does not have the recorded size
+    uncorrectable,      // at least one codeword could not be repaired
+};
+
+struct rs_file_report {
+    rs_file_status status = rs_file_status::ok;
+    uint64_t codewords = 0;
+    uint64_t clean = 0;
+    uint64_t corrected = 0;     // symbols, data and parity
+    uint64_t failed = 0;        // codewords
+};
+
+namespace detail {
+    class mapped_file {
+    public:
+        mapped_file() = default;
+        mapped_file(mapped_file const&) = delete;
+        mapped_file& operator=(mapped_file const&) = delete;
+
+        ~mapped_file() {
+            if (ptr)
+                munmap(ptr, len);
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        // size > 0 creates or truncates the file to that size
+        inline bool open(const char *path, bool writable, uint64_t size = 0) {
+            fd = ::open(path, size ? O_RDWR | O_CREAT | O_TRUNC : writable ? O_RDWR : O_RDONLY, 0644);
+            if (fd < 0)
+                return false;
+
+            if (size) {
+                if (ftruncate(fd, off_t(size)) != 0)
+                    return false;
+                writable = true;
+            } else {
+                struct stat st;
+                if (fstat(fd, &st) != 0)
+                    return false;
+                size = uint64_t(st.st_size);
+            }
+
+            len = size;
+            if (len == 0)
+                return true;
+
+            void *p = mmap(nullptr, len, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                    writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+                return false;
+
+            ptr = static_cast<uint8_t *>(p);
+            madvise(ptr, len, MADV_SEQUENTIAL);
+            return true;
+        }
+
+        inline uint8_t *data() const { return ptr; }
+        inline uint64_t size() const { return len; }
+
+    private:
+        int fd = -1;
+        uint8_t *ptr = nullptr;
+        uint64_t len = 0;
+    };
+
+    struct alignas(64) rs_file_counters {
+        uint64_t codewords = 0;
+        uint64_t clean = 0;
+        uint64_t corrected = 0;
+        uint64_t failed = 0;
+    };
+
+    template<unsigned Ecc>
+    struct rs_file_codec {
+        using RS = ::RS<rs_file_gf, Ecc, rs_encode_lut, rs_synds_lut8, rs_roots_eval_chien64, rs_decode>;
+        using result = typename RS::result;
+
+        static constexpr unsigned data_len = 255 - Ecc;
+        static constexpr unsigned n = 255;
+
+        // Transposes stripe s of the file into contiguous codewords block[j * n + i]
+        static inline void gather_data(uint8_t block[], rs_file_header const& h, const uint8_t *file, uint64_t s) {
+            const unsigned d = h.interleave;
+            const uint64_t base = s * h.stripe_len();
+            const uint8_t *src = &file[base];
+
+            if (base + h.stripe_len() <= h.file_size) {
+                for (unsigned i = 0; i < data_len; ++i, src += d)
+                    for (unsigned j = 0; j < d; ++j)
+                        block[j * n + i] = src[j];
+            } else {
+                for (unsigned i = 0; i < data_len; ++i)
+                    for (unsigned j = 0; j < d; ++j) {
+                        uint64_t off = base + uint64_t(i) * d + j;
+                        block[j * n + i] = off < h.file_size ? file[off] : 0;
+                    }
+            }
+        }
+
+        static inline void encode(rs_thread_pool& pool, rs_file_header const& h, const uint8_t *file, uint8_t *parity) {
+            std::vector<uint8_t> scratch(size_t(pool.size()) * h.interleave * n);
+
+            for_stripes(pool, h, [&](uint64_t s, unsigned thread) {
+                uint8_t *block = &scratch[size_t(thread) * h.interleave * n];
+                gather_data(block, h, file, s);
+
+                for (unsigned j = 0; j < h.interleave; ++j)
+                    RS::encode(&parity[(s * h.interleave + j) * Ecc], &block[j * n], data_len);
+            });
+        }
+
+        static inline void verify(rs_thread_pool& pool, rs_file_header const& h, uint8_t *file, uint8_t *parity,
+                bool repair, rs_file_report& report) {
+            const unsigned d = h.interleave;
+            std::vector<uint8_t> scratch(size_t(pool.size()) * d * n);
+            std::vector<result> results(size_t(pool.size()) * d);
+            std::vector<rs_file_counters> counters(pool.size());
+
+            for_stripes(pool, h, [&](uint64_t s, unsigned thread) {
+                uint8_t *block = &scratch[size_t(thread) * d * n];
+                result *res = &results[size_t(thread) * d];
+                auto& c = counters[thread];
+
+                gather_data(block, h, file, s);
+                for (unsigned j = 0; j < d; ++j)
+                    std::copy_n(&parity[(s * d + j) * Ecc], Ecc, &block[j * n + data_len]);
+
+                RS::decode_batch(block, d, data_len, res);
+                c.codewords += d;
+
+                for (unsigned j = 0; j < d; ++j) {
+                    auto& r = res[j];
+                    const uint64_t base = s * h.stripe_len() + j;
+
+                    // a correction inside the zero padding means the decoder went astray
+                    bool ok = bool(r) && std::all_of(&r.positions[0], &r.positions[r.corrected],
+                            [&](unsigned p) { return p >= data_len || base + uint64_t(p) * d < h.file_size; });
+
+                    if (!ok) {
+                        c.failed += 1;
+                        continue;
+                    }
+
+                    c.clean += r.corrected == 0;
+                    c.corrected += r.corrected;
+
+                    if (!repair)
+                        continue;
+
+                    for (unsigned k = 0; k < r.corrected; ++k) {
+                        unsigned p = r.positions[k];
+                        if (p < data_len)
+                            file[base + uint64_t(p) * d] = block[j * n + p];
+                        else
+                            parity[(s * d + j) * Ecc + p - data_len] = block[j * n + p];
+                    }
+                }
+            });
+
+            for (auto& c : counters) {
+                report.codewords += c.codewords;
+                report.clean += c.clean;
+                report.corrected += c.corrected;
+                report.failed += c.failed;
+            }
+        }
+
+        template<typename F>
+        static inline void for_stripes(rs_thread_pool& pool, rs_file_header const& h, F&& fn) {
+            constexpr uint64_t chunk = uint64_t(1) << 30;
+
+            for (uint64_t first = 0; first < h.stripes; first += chunk) {
+                auto count = uint32_t(std::min(chunk, h.stripes - first));
+                pool.run(count, 16, [&](uint32_t begin, uint32_t end, unsigned thread) {
+                    for (uint32_t i = begin; i < end; ++i)
+                        fn(first + i, thread);
+                });
+            }
+        }
+    };
+
+    // Calls fn(rs_file_codec<Ecc>{}) for the compiled ecc matching the runtime value
+    template<unsigned...Eccs, typename F>
+    static inline bool rs_file_dispatch_of(unsigned ecc, F&& fn) {
+        return ((ecc == Eccs ? (fn(rs_file_codec<Eccs>{}), true) : false) || ...);
+    }
+
+    template<typename F>
+    static inline bool rs_file_dispatch(unsigned ecc, F&& fn) {
+        return rs_file_dispatch_of<2, 4, 8, 16, 32>(ecc, std::forward<F>(fn));
+    }
+}
+
+static inline bool rs_file_ecc_supported(unsigned ecc) {
+    return detail::rs_file_dispatch(ecc, [](auto) {});
+}
+
+// Writes the sidecar parity file for `path`
+static inline rs_file_report rs_file_protect(rs_thread_pool& pool, const char *path, const char *parity_path,
+        unsigned ecc, unsigned interleave) {
+    rs_file_report report;
+
+    if (!rs_file_ecc_supported(ecc) || interleave == 0 || interleave > rs_file_header::max_interleave) {
+        report.status = rs_file_status::unsupported;
+        return report;
+    }
+
+    detail::mapped_file file;
+    if (!file.open(path, false)) {
+        report.status = rs_file_status::io_error;
+        return report;
+    }
+
+    rs_file_header h = {};
+    std::copy_n(rs_file_header::magic_value, sizeof(h.magic), h.magic);
+    h.version = rs_file_header::version_value;
+    h.field_power = rs_file_gf::power;
+    h.field_poly = 0x100 | rs_file_gf::poly1;
+    h.ecc = ecc;
+    h.data_len = 255 - ecc;
+    h.interleave = interleave;
+    h.file_size = file.size();
+    h.stripes = (h.file_size + h.stripe_len() - 1) / h.stripe_len();
+    h.checksum = h.compute_checksum();
+
+    detail::mapped_file parity;
+    if (!parity.open(parity_path, true, h.parity_size())) {
+        report.status = rs_file_status::io_error;
+        return report;
+    }
+
+    std::memcpy(parity.data(), &h, sizeof(h));
+    detail::rs_file_dispatch(ecc, [&](auto codec) {
+        codec.encode(pool, h, file.data(), parity.data() + sizeof(h));
+    });
+
+    report.codewords = h.stripes * h.interleave;
+    report.clean = report.codewords;
+    return report;
+}
+
+// Checks `path` against its sidecar; with `repair` both files are corrected in place
+static inline rs_file_report rs_file_verify(rs_thread_pool& pool, const char *path, const char *parity_path,
+        bool repair) {
+    rs_file_report report;
+
+    detail::mapped_file parity;
+    if (!parity.open(parity_path, repair)) {
+        report.status = rs_file_status::io_error;
+        return report;
+    }
+
+    rs_file_header h;
+    if (parity.size() < sizeof(h)) {
+        report.status = rs_file_status::bad_header;
+        return report;
+    }
+
+    std::memcpy(&h, parity.data(), sizeof(h));
+
+    if (!std::equal(h.magic, h.magic + sizeof(h.magic), rs_file_header::magic_value)
+            || h.checksum != h.compute_checksum()) {
+        report.status = rs_file_status::bad_header;
+        return report;
+    }
+
+    if (h.version != rs_file_header::version_value || h.field_power != rs_file_gf::power
+            || h.field_poly != (0x100 | rs_file_gf::poly1) || !rs_file_ecc_supported(h.ecc)
+            || h.data_len != 255 - h.ecc || h.interleave == 0 || h.interleave > rs_file_header::max_interleave) {
+        report.status = rs_file_status::unsupported;
+        return report;
+    }
+
+    if (h.stripes != (h.file_size + h.stripe_len() - 1) / h.stripe_len() || parity.size() != h.parity_size()) {
+        report.status = rs_file_status::bad_header;
+        return report;
+    }
+
+    detail::mapped_file file;
+    if (!file.open(path, repair)) {
+        report.status = rs_file_status::io_error;
+        return report;
+    }
+
+    if (file.size() != h.file_size) {
+        report.status = rs_file_status::size_mismatch;
+        return report;
+    }
+
+    detail::rs_file_dispatch(h.ecc, [&](auto codec) {
+        codec.verify(pool, h, file.data(), parity.data() + sizeof(h), repair, report);
+    });
+
+    if (report.failed)
+        report.status = rs_file_status::uncorrectable;
+
+    return report;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#include <cxxabi.h>
+
+#include "galois.hpp"
+
+// One static table used by a policy. Policies that share a table (field tables, generators)
+// report the same address, so the distinct footprint of several codecs can be added up.
+struct footprint_entry {
+    std::string policy;
+    size_t bytes;
+    const void *table;
+    bool shared;        // the table is keyed on the field or code, not owned by this policy
+};
+
+namespace detail {
+    template<typename T, typename = void>
+    struct has_sdata : std::false_type { };
+    template<typename T>
+    struct has_sdata<T, std::void_t<decltype(&T::sdata)>> : std::true_type { };
+
+    // Demangled policy name without the (long, repeated) field or code argument
+    template<typename T>
+    std::string policy_name() {
+        int status = 0;
+        std::unique_ptr<char, void (*)(void *)> demangled(
+                abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status), std::free);
+        std::string name = status == 0 ? demangled.get() : typeid(T).name();
+
+        for (auto marker : {"<rs_impl_base<", "<rs_base<", "<gf_impl_base<", "<gf_base<"}) {
+            for (size_t pos; (pos = name.find(marker)) != std::string::npos;) {
+                size_t end = pos + 1;
+                for (int depth = 1; depth > 0 && ++end < name.size();)
+                    depth += (name[end] == '<') - (name[end] == '>');
+                name.erase(pos, end + 1 - pos);
+            }
+        }
+
+        return name;
+    }
+
+    template<typename...Ts>
+    void add_footprint(std::vector<footprint_entry>& out, type_list<Ts...>) {
+        ([&] {
+            if constexpr (has_sdata<Ts>::value)
+                out.push_back({policy_name<Ts>(), sizeof(std::remove_reference_t<decltype(Ts::sdata)>),
+                        &Ts::sdata, std::is_reference_v<decltype(Ts::sdata)>});
+        }(), ...);
+    }
+}
+
+// Static tables of a field or codec and of every policy, shared ones included
+template<typename Codec>
+inline std::vector<footprint_entry> policy_footprint() {
+    std::vector<footprint_entry> out;
+    detail::add_footprint(out, typename Codec::sdata_policies());
+    return out;
+}
+
+// Bytes of distinct tables in a footprint, possibly gathered from several codecs
+inline size_t footprint_bytes(std::vector<footprint_entry> const& entries) {
+    size_t total = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; ++j)
+            seen = entries[j].table == entries[i].table;
+        total += seen ? 0 : entries[i].bytes;
+    }
+    return total;
+}
+
+inline void write_footprint(std::FILE *f, std::vector<footprint_entry> const& entries) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; ++j)
+            seen = entries[j].table == entries[i].table;
+
+        std::fprintf(f, "%-60s %9zu%s%s\n", entries[i].policy.c_str(), entries[i].bytes,
+                entries[i].shared ? "  shared" : "", seen ? ", counted above" : "");
+    }
+    std::fprintf(f, "%-60s %9zu\n", "total (distinct tables)", footprint_bytes(entries));
+}
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
 
 namespace detail {
     static inline constexpr unsigned ilog2_floor(unsigned a) {
@@ -80,23 +81,58 @@ struct gf_mul_cpu {
     static inline constexpr GFT mul(GFT const& lhs, GFT const& rhs) { return (lhs * rhs) % GF::prime; }
 };
 
+namespace detail {
+    // Exp/log tables depend only on the field, so they are keyed on gf_base: every GF<...> of
+    // the same field shares one copy whatever other policies it was built with
+    template<typename Field>
+    struct gf_exp_log_data {
+        using GFT = typename Field::Repr;
+
+        static inline constexpr struct sdata_t {
+            std::array<GFT, Field::charact> exp{};
+            std::array<GFT, Field::charact> log{};
+
+            constexpr inline sdata_t() {
+                GFT x = 1;
+                for (unsigned i = 0; i < Field::charact; ++i) {
+                    exp[i] = x;
+                    log[x] = i;
+
+                    if constexpr (Field::prime == 2 && Field::primitive == 2)
+                        x = (x & (Field::charact >> 1)) ? GFT((x << 1) ^ Field::poly1) : GFT(x << 1);
+                    else
+                        x = gf_mul_cpu<Field>::mul(x, Field::primitive);
+                }
+            }
+        } sdata{};
+    };
+
+    template<typename Field>
+    struct gf_mul_lut_data {
+        using GFT = typename Field::Repr;
+
+        static inline constexpr struct sdata_t {
+            GFT mul[Field::charact][Field::charact] = {};
+
+            constexpr inline sdata_t() {
+                for (unsigned i = 0; i < Field::charact; ++i) {
+                    for (unsigned j = 0; j < Field::charact; ++j)
+                        mul[i][j] = gf_mul_cpu<Field>::mul(i, j);
+                }
+            }
+        } sdata{};
+    };
+
+    template<typename Field>
+    using gf_key = gf_base<typename Field::Repr, Field::prime, Field::power, Field::primitive, Field::poly1>;
+}
+
 template<typename GF>
 struct gf_exp_log_lut {
     using GFT = typename GF::Repr;
+    using sdata_t = typename detail::gf_exp_log_data<detail::gf_key<GF>>::sdata_t;
 
-    static inline constexpr struct sdata_t {
-        std::array<GFT, GF::charact> exp{};
-        std::array<GFT, GF::charact> log{};
-
-        constexpr inline sdata_t() {
-            GFT x = 1;
-            for (unsigned i = 0; i < GF::charact; ++i) {
-                exp[i] = x;
-                log[x] = i;
-                x = gf_mul_cpu<GF>::mul(x, GF::primitive);
-            }
-        }
-    } sdata{};
+    static constexpr auto& sdata = detail::gf_exp_log_data<detail::gf_key<GF>>::sdata;
 
     static inline constexpr GFT inv(GFT const& a) {
         return sdata.exp[GF::charact-1 - sdata.log[a]];
@@ -131,16 +167,9 @@ struct gf_mul_lut {
     using GFT = typename GF::Repr;
     static_assert(GF::charact <= 4096); // limit 16MB
 
-    static inline constexpr struct sdata_t {
-        GFT mul[GF::charact][GF::charact] = {};
+    using sdata_t = typename detail::gf_mul_lut_data<detail::gf_key<GF>>::sdata_t;
 
-        constexpr inline sdata_t() {
-            for (unsigned i = 0; i < GF::charact; ++i) {
-                for (unsigned j = 0; j < GF::charact; ++j)
-                    mul[i][j] = gf_mul_cpu<GF>::mul(i, j);
-            }
-        }
-    } sdata{};
+    static constexpr auto& sdata = detail::gf_mul_lut_data<detail::gf_key<GF>>::sdata;
 
     static inline constexpr GFT mul(GFT const& a, GFT const& b) {
         return sdata.mul[a][b];
@@ -165,6 +194,28 @@ struct gf_mul_exp_log_lut {
     }
 };
 
+namespace detail {
+    // In-place transpose of a 64x64 bit matrix, MSB first: bit 63-c of row r becomes
+    // bit 63-r of row c
+    static inline void transpose64(uint64_t a[64]) {
+        uint64_t m = 0x00000000ffffffffull;
+        for (unsigned j = 32; j != 0; j >>= 1, m ^= m << j) {
+            for (unsigned k = 0; k < 64; k = (k + j + 1) & ~j) {
+                uint64_t t = (a[k] ^ (a[k + j] >> j)) & m;
+                a[k] ^= t;
+                a[k + j] ^= t << j;
+            }
+        }
+    }
+
+    static inline uint64_t load_be64(const uint8_t p[8]) {
+        uint64_t r = 0;
+        for (unsigned i = 0; i < 8; ++i)
+            r = (r << 8) | p[i];
+        return r;
+    }
+}
+
 template<typename GF, typename Word>
 class gf_wide_mul {
     static_assert(std::is_same_v<typename GF::Repr, uint8_t>);
@@ -220,6 +271,13 @@ namespace detail {
         else
             return get_sdata_size_helper<T>::value;
     }
+
+    // Policies of a codec, in the order their tables are reported by footprint.hpp
+    template<typename...Ts>
+    struct type_list {
+        template<typename...Us>
+        using append = type_list<Ts..., Us...>;
+    };
 }
 
 template<typename GF>
@@ -391,6 +449,8 @@ struct gf_impl : gf_base<typename Impl::Repr, Impl::prime, Impl::power, Impl::pr
     static inline auto static_data_size = detail::get_sdata_size<Fs<Impl>...>();
     typename Impl::Repr value;
 
+    using sdata_policies = detail::type_list<Fs<Impl>...>;
+
     explicit inline constexpr gf_impl(): value(typename Impl::Repr()) { }
     explicit inline constexpr gf_impl(typename Impl::Repr const& v): value(v) { }
 
@@ -418,3 +478,19 @@ struct GF :
 {
     using gf_impl<gf_impl_base<T, Prime, Power, Primitive, Poly1, Fs...>, Fs...>::gf_impl;
 };
+
+namespace detail {
+    // The field with a fixed, table-light policy set, for tables that are computed once per
+    // field (or per field and ecc) regardless of the policies of the GF<...> that asks
+    template<typename Field>
+    struct gf_canonical {
+        template<typename F>
+        using add = std::conditional_t<Field::prime == 2, gf_add_xor<F>, gf_add_ring<F>>;
+
+        using type = GF<typename Field::Repr, Field::prime, Field::power, Field::primitive, Field::poly1,
+                add, gf_mul_cpu, gf_exp_log_lut>;
+    };
+
+    template<typename Field>
+    using gf_canonical_t = typename gf_canonical<Field>::type;
+}
@@ -0,0 +1,232 @@
+// Micro-benchmarks for the field kernels in galois.hpp, with hardware counters per kernel.
+//
+// usage: gf_bench [--reps n] [--format text|csv] [--filter substring]
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "galois.hpp"
+#include "perf_counters.hpp"
+
+template<template<class>typename Mul>
+using GF256_with = GF<uint8_t, 2, 8, 2, 0x11d & 0xff, gf_add_xor, gf_exp_log_lut, Mul>;
+using GF64k = GF<uint16_t, 2, 16, 2, 0x1002d & 0xffff, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+
+static volatile uint64_t sink;
+
+struct kernel {
+    std::string name;
+    double ops;                         // operations per call of run
+    std::function<uint64_t()> run;
+};
+
+static constexpr unsigned array_size = 1 << 16;
+
+template<typename T>
+static std::vector<T> random_symbols(std::mt19937_64& rng, unsigned count, unsigned charact) {
+    std::vector<T> v(count);
+    for (auto& x : v)
+        x = T(rng() % charact);
+    return v;
+}
+
+template<typename GF>
+static void add_mul(std::vector<kernel>& ks, std::mt19937_64& rng, const char *name) {
+    using GFT = typename GF::Repr;
+    auto a = random_symbols<GFT>(rng, array_size, GF::charact);
+    auto b = random_symbols<GFT>(rng, array_size, GF::charact);
+
+    ks.push_back({std::string("mul/") + name, array_size, [a, b] {
+        uint64_t acc = 0;
+        for (unsigned i = 0; i < array_size; ++i)
+            acc ^= GF::mul(a[i], b[i]);
+        return acc;
+    }});
+}
+
+template<typename GF>
+static void add_eval(std::vector<kernel>& ks, std::mt19937_64& rng, const char *name) {
+    using GFT = typename GF::Repr;
+    constexpr unsigned count = 256;
+    const unsigned size = 255;
+
+    auto polys = random_symbols<GFT>(rng, count * size, GF::charact);
+    auto xs = random_symbols<GFT>(rng, count, GF::charact);
+
+    ks.push_back({std::string("poly_eval/") + name, double(count) * size, [=] {
+        uint64_t acc = 0;
+        for (unsigned k = 0; k < count; ++k)
+            acc ^= GF::poly_eval(&polys[k * size], size, xs[k]);
+        return acc;
+    }});
+}
+
+template<typename GF>
+static void add_div(std::vector<kernel>& ks, std::mt19937_64& rng, const char *name, unsigned ecc) {
+    using GFT = typename GF::Repr;
+    constexpr unsigned count = 256;
+    const unsigned size = 255;
+
+    auto polys = random_symbols<GFT>(rng, count * size, GF::charact);
+    auto divisor = random_symbols<GFT>(rng, ecc + 1, GF::charact);
+    divisor[0] = 1;
+
+    ks.push_back({std::string("poly_mod_x_n/") + name + "/ecc" + std::to_string(ecc), double(count) * size, [=] {
+        uint64_t acc = 0;
+        GFT rem[64];
+        for (unsigned k = 0; k < count; ++k) {
+            GF::poly_mod_x_n(rem, &polys[k * size], size - ecc, &divisor[1], ecc);
+            acc ^= rem[0];
+        }
+        return acc;
+    }});
+
+    ks.push_back({std::string("ex_synth_div/") + name + "/ecc" + std::to_string(ecc), double(count) * size, [=] {
+        uint64_t acc = 0;
+        std::vector<GFT> work(size);
+        for (unsigned k = 0; k < count; ++k) {
+            std::copy_n(&polys[k * size], size, work.data());
+            GF::ex_synth_div(work.data(), size, divisor.data(), ecc + 1);
+            acc ^= work[size - 1];
+        }
+        return acc;
+    }});
+}
+
+template<typename Word>
+static void add_wide(std::vector<kernel>& ks, std::mt19937_64& rng, const char *name) {
+    using GF = GF256_with<gf_mul_exp_log_lut>;
+    using wide = gf_wide_mul<GF, Word>;
+    constexpr unsigned words = array_size / sizeof(Word);
+
+    std::vector<Word> a(words), b(words);
+    for (unsigned i = 0; i < words; ++i) {
+        a[i] = Word(rng());
+        b[i] = Word(rng());
+    }
+
+    ks.push_back({std::string("wide_mul/") + name, array_size, [a, b] {
+        uint64_t acc = 0;
+        for (unsigned i = 0; i < words; ++i)
+            acc ^= uint64_t(wide::mul(a[i], b[i]));
+        return acc;
+    }});
+
+    constexpr unsigned count = 256;
+    constexpr unsigned size = 255;
+    auto polys = random_symbols<uint8_t>(rng, count * size, 256);
+
+    ks.push_back({std::string("wide_poly_eval/") + name, double(count) * size * sizeof(Word), [polys, a] {
+        uint64_t acc = 0;
+        for (unsigned k = 0; k < count; ++k)
+            acc ^= uint64_t(wide::poly_eval(&polys[k * size], size, a[k]));
+        return acc;
+    }});
+}
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr, "usage: %s [--reps n] [--format text|csv] [--filter substring]\n", argv0);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned reps = 7;
+    std::string format = "text";
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (arg == "--reps")
+            reps = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--format") {
+            format = argv[++i];
+            if (format != "text" && format != "csv") {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "--filter")
+            filter = argv[++i];
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<kernel> ks;
+
+    add_mul<GF256_with<gf_mul_cpu>>(ks, rng, "cpu");
+    add_mul<GF256_with<gf_mul_lut>>(ks, rng, "lut");
+    add_mul<GF256_with<gf_mul_exp_log_lut>>(ks, rng, "exp_log_lut");
+    add_mul<GF64k>(ks, rng, "exp_log_lut/gf64k");
+
+    add_eval<GF256_with<gf_mul_cpu>>(ks, rng, "cpu");
+    add_eval<GF256_with<gf_mul_lut>>(ks, rng, "lut");
+    add_eval<GF256_with<gf_mul_exp_log_lut>>(ks, rng, "exp_log_lut");
+
+    for (unsigned ecc : {8u, 32u}) {
+        add_div<GF256_with<gf_mul_cpu>>(ks, rng, "cpu", ecc);
+        add_div<GF256_with<gf_mul_lut>>(ks, rng, "lut", ecc);
+        add_div<GF256_with<gf_mul_exp_log_lut>>(ks, rng, "exp_log_lut", ecc);
+    }
+
+    add_wide<uint32_t>(ks, rng, "u32");
+    add_wide<uint64_t>(ks, rng, "u64");
+
+    perf_counters pc;
+
+    if (format == "csv")
+        std::printf("kernel,ops,ns_per_op,cycles_per_op,ipc,l1d_misses_per_op,branch_misses_per_op,source\n");
+    else
+        std::printf("%-32s %9s %9s %7s %10s %10s  %s\n",
+                "kernel", "ns/op", "cyc/op", "IPC", "L1D mis/op", "br mis/op", "source");
+
+    for (auto& k : ks) {
+        if (!filter.empty() && k.name.find(filter) == std::string::npos)
+            continue;
+
+        sink = k.run();     // warm tables and caches
+
+        // keep the fastest repetition, the one least disturbed by the rest of the system
+        perf_counters::sample best;
+        for (unsigned r = 0; r < reps; ++r) {
+            pc.start();
+            sink = k.run();
+            auto s = pc.stop();
+
+            if (r == 0 || s.ns < best.ns)
+                best = s;
+        }
+
+        const char *source = best.tsc ? "tsc" : "perf";
+        if (format == "csv") {
+            std::printf("%s,%.0f,%.3f,%.3f,%.3f,%.5f,%.5f,%s\n", k.name.c_str(), k.ops, best.ns / k.ops,
+                    best.per(perf_counters::cycles, k.ops), best.ipc(),
+                    best.per(perf_counters::l1d_misses, k.ops), best.per(perf_counters::branch_misses, k.ops),
+                    source);
+        } else {
+            auto opt = [](double v, const char *fmt, char *buf) {
+                if (v < 0)
+                    return "-";
+                std::snprintf(buf, 32, fmt, v);
+                return static_cast<const char *>(buf);
+            };
+            char b0[32], b1[32], b2[32], b3[32];
+
+            std::printf("%-32s %9.3f %9s %7s %10s %10s  %s\n", k.name.c_str(), best.ns / k.ops,
+                    opt(best.per(perf_counters::cycles, k.ops), "%.3f", b0), opt(best.ipc(), "%.2f", b1),
+                    opt(best.per(perf_counters::l1d_misses, k.ops), "%.5f", b2),
+                    opt(best.per(perf_counters::branch_misses, k.ops), "%.5f", b3), source);
+        }
+    }
+
+    return 0;
+}
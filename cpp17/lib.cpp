@@ -1,4 +1,11 @@
 #define RS_GENERATOR_LUT
+#include <numeric>
+#include <vector>
+
+#include "bch.hpp"
+#include "erasure_code.hpp"
+#include "footprint.hpp"
+#include "parallel.hpp"
 #include "reed_solomon.hpp"
 
 static const auto ecclen = 4;
@@ -6,13 +13,101 @@ using GF256 = GF<uint8_t, 2, 8, 2, 0x11d & 0xff, gf_add_xor, gf_exp_log_lut, gf_
 using RS0 = RS<GF256, ecclen, rs_encode_basic, rs_synds_lut8, rs_roots_eval_basic, rs_decode>;
 
 using GF257 = GF<uint16_t, 257, 1, 3, 0, gf_add_ring, gf_mul_cpu, gf_exp_log_lut>;
-using RS1 = RS<GF257, ecclen, rs_encode_basic, rs_synds_basic, rs_roots_eval_basic, rs_decode>;
+using RS1 = RS<GF257, ecclen, rs_encode_basic, rs_synds_basic, rs_roots_eval_chien32, rs_decode, rs_erasure_plans>;
+
+using RS2 = RS<GF256, 8, rs_encode_slice<uint64_t, 8>::type, rs_synds_lut8,
+        rs_roots_direct_t<rs_roots_eval_chien64>::type, rs_decode, rs_decode_stats, rs_decode_trace, rs_erasure_plans>;
+
+using GF64k = GF<uint16_t, 2, 16, 2, 0x1002d & 0xffff, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+using RS3 = RS<GF64k, 8, rs_encode_basic, rs_synds_basic, rs_roots_eval_chien16, rs_decode>;
+
+using RS8_nibble = RS<GF256, 8, rs_encode_nibble>;
+using RS8_512 = RS<GF256, 8, rs_encode_budget_t<512>::type>;
+using RS8_4k = RS<GF256, 8, rs_encode_budget_t<4096>::type>;
+using RS8_64k = RS<GF256, 8, rs_encode_budget_t<65536>::type>;
+
+using GF64 = GF<uint8_t, 2, 6, 2, 0x43, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+using BCH63_45 = BCH<GF64, 3, 63, bch_encode_slice8, bch_synds_minpoly, bch_roots_chien, bch_decode, bch_batch256>;
+using BCH63_30 = BCH<GF64, 6, 63, bch_encode_slice4, bch_synds_minpoly, bch_roots_chien, bch_decode, bch_batch64>;
+
+// long codes: a 512-byte sector with t = 40, a 2 KB page with t = 72, and a full-length
+// n = 8191 code whose message is not a whole number of bytes
+using GF8k = GF<uint16_t, 2, 13, 2, 0x201b, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+using GF32k = GF<uint16_t, 2, 15, 2, 0x8003, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+using BCH4616_40 = BCH<GF8k, 40, 4616, bch_encode_lfsr8, bch_synds_remainder, bch_roots_bitslice256, bch_decode>;
+using BCH4616_40_ref = BCH<GF8k, 40, 4616, bch_encode_lfsr_t<1>::type, bch_synds_basic, bch_roots_chien, bch_decode>;
+using BCH17464_72 = BCH<GF32k, 72, 17464, bch_encode_lfsr8, bch_synds_remainder, bch_roots_bitslice128, bch_decode>;
+using BCH8191_8 = BCH<GF8k, 8, 8191, bch_encode_lfsr4, bch_synds_minpoly, bch_roots_bitslice128, bch_decode>;
+
+using EC8 = erasure_code<GF256, 6, 3>;
+using EC64k = erasure_code<GF64k, 10, 4>;
 
 struct context {
     RS0 rs0;
     RS1 rs1;
+    RS2 rs2;
+    RS3 rs3;
+    rs_thread_pool pool;
 };
 
+template<typename EC, typename T>
+static inline void ec_fragments(T *frags[], T a[], unsigned len) {
+    for (unsigned i = 0; i < EC::k + EC::m; ++i)
+        frags[i] = &a[i * len];
+}
+
+template<typename BCH>
+static inline int bch_decode_status(uint8_t a[]) {
+    auto r = BCH::decode(a);
+    return r ? int(r.corrected) : -int(r.status);
+}
+
+template<typename Synds>
+static inline bool bch_synds_with(const uint8_t a[], uint8_t synds[]) {
+    return Synds::synds(a, synds);
+}
+
+template<typename BCH>
+static inline unsigned bch_decode_batch_status(uint8_t a[], unsigned count, int status[]) {
+    std::vector<typename BCH::result> results(count);
+    auto failed = BCH::decode_batch(a, count, results.data());
+
+    for (unsigned i = 0; i < count; ++i)
+        status[i] = results[i] ? int(results[i].corrected) : -int(results[i].status);
+
+    return unsigned(failed);
+}
+
+template<typename BCH>
+static inline int bch_long_op(unsigned op, uint8_t a[]) {
+    if (op == 0)
+        BCH::encode(a);
+    else if (op == 1)
+        return BCH::check(a);
+    else
+        return bch_decode_status<BCH>(a);
+    return 0;
+}
+
+template<typename RS>
+static inline void encode_with(uint8_t a[], unsigned size) {
+    RS::encode(a + size - RS::ecc, a, size - RS::ecc);
+}
+
+// Distinct static table bytes of the codecs whose bit is set in mask
+template<typename...Codecs>
+static inline size_t footprint_of(unsigned mask) {
+    std::vector<footprint_entry> entries;
+    unsigned bit = 0;
+    ([&] {
+        if (mask & (1u << bit++)) {
+            auto f = policy_footprint<Codecs>();
+            entries.insert(entries.end(), f.begin(), f.end());
+        }
+    }(), ...);
+    return footprint_bytes(entries);
+}
+
 extern "C" {
 
 void *gf_init() {
@@ -103,4 +198,197 @@ void decode257(void *rs, uint16_t a[], unsigned size) {
     reinterpret_cast<context *>(rs)->rs1.decode(a, size - RS1::ecc, a + size - RS1::ecc);
 }
 
+void encode8(void *rs, uint8_t a[], unsigned size) {
+    reinterpret_cast<context *>(rs)->rs2.encode(a + size - RS2::ecc, a, size - RS2::ecc);
+}
+
+bool decode8(void *rs, uint8_t a[], unsigned size) {
+    return bool(reinterpret_cast<context *>(rs)->rs2.decode(a, size - RS2::ecc, a + size - RS2::ecc));
+}
+
+int decode8_positions(void *rs, uint8_t a[], unsigned size, unsigned positions[]) {
+    auto r = reinterpret_cast<context *>(rs)->rs2.decode(a, size - RS2::ecc, a + size - RS2::ecc);
+    if (!r)
+        return -1;
+
+    std::copy_n(r.positions, r.corrected, positions);
+    return r.corrected;
+}
+
+unsigned decode8_batch(void *rs, uint8_t a[], unsigned blocks, unsigned size, int corrected[]) {
+    std::vector<RS2::result> results(blocks);
+    auto failed = reinterpret_cast<context *>(rs)->rs2.decode_batch(a, blocks, size - RS2::ecc, results.data());
+
+    for (unsigned i = 0; i < blocks; ++i)
+        corrected[i] = results[i] ? int(results[i].corrected) : -1;
+
+    return failed;
+}
+
+void encode8_parallel(void *rs, uint8_t a[], unsigned blocks, unsigned size) {
+    rs_parallel_encode<RS2>(reinterpret_cast<context *>(rs)->pool, a, blocks, size - RS2::ecc);
+}
+
+unsigned decode8_parallel(void *rs, uint8_t a[], unsigned blocks, unsigned size) {
+    return unsigned(rs_parallel_decode<RS2>(reinterpret_cast<context *>(rs)->pool, a, blocks, size - RS2::ecc));
+}
+
+void encode8_budget(void *, uint8_t a[], unsigned size, unsigned policy) {
+    switch (policy) {
+    case 0: return encode_with<RS8_nibble>(a, size);
+    case 1: return encode_with<RS8_512>(a, size);
+    case 2: return encode_with<RS8_4k>(a, size);
+    case 3: return encode_with<RS8_64k>(a, size);
+    }
+}
+
+size_t footprint(void *, unsigned mask) {
+    return footprint_of<RS0, RS1, RS2, RS3, RS8_nibble, RS8_512, RS8_4k, RS8_64k>(mask);
+}
+
+void decode8_stats(void *rs, uint64_t stats[4]) {
+    auto& s = RS2::decode_stats;
+    stats[0] = s.blocks;
+    stats[1] = s.clean;
+    stats[2] = s.symbols;
+    stats[3] = s.blocks - std::accumulate(std::begin(s.corrected), std::end(s.corrected), uint64_t(0));
+}
+
+// count, p50, p99 and p999 in ns of one decode stage, summed over every thread
+void decode8_trace(void *, unsigned stage, uint64_t summary[4]) {
+    auto s = RS2::decode_trace_snapshot();
+    auto st = rs_decode_stage::stage_t(stage);
+
+    summary[0] = s.count(st);
+    summary[1] = s.percentile(st, 0.5);
+    summary[2] = s.percentile(st, 0.99);
+    summary[3] = s.percentile(st, 0.999);
+}
+
+void decode8_trace_errors(void *, uint64_t errors[RS2::ecc + 1]) {
+    auto s = RS2::decode_trace_snapshot();
+    std::copy(std::begin(s.errors), std::end(s.errors), errors);
+}
+
+void decode8_trace_reset(void *) {
+    RS2::decode_trace_reset();
+}
+
+unsigned roots8(void *rs, const uint8_t poly[], unsigned size, uint8_t roots[]) {
+    return reinterpret_cast<context *>(rs)->rs2.roots(poly, size, roots, 255);
+}
+
+void encode64k(void *rs, uint16_t a[], unsigned size) {
+    reinterpret_cast<context *>(rs)->rs3.encode(a + size - RS3::ecc, a, size - RS3::ecc);
+}
+
+bool decode64k(void *rs, uint16_t a[], unsigned size) {
+    return bool(reinterpret_cast<context *>(rs)->rs3.decode(a, size - RS3::ecc, a + size - RS3::ecc));
+}
+
+bool decode_erasures(void *rs, uint8_t a[], unsigned size, const unsigned erasures[], unsigned count) {
+    return bool(reinterpret_cast<context *>(rs)->rs0.decode(a, size - RS0::ecc, a + size - RS0::ecc, erasures, count));
+}
+
+bool decode8_erasures(void *rs, uint8_t a[], unsigned size, const unsigned erasures[], unsigned count) {
+    return bool(reinterpret_cast<context *>(rs)->rs2.decode(a, size - RS2::ecc, a + size - RS2::ecc, erasures, count));
+}
+
+bool decode257_erasures(void *rs, uint16_t a[], unsigned size, const unsigned erasures[], unsigned count) {
+    return bool(reinterpret_cast<context *>(rs)->rs1.decode(a, size - RS1::ecc, a + size - RS1::ecc, erasures, count));
+}
+
+void erasure_plans8_stats(void *rs, uint64_t stats[2]) {
+    auto& plans = RS2::erasure_plans();
+    stats[0] = plans.hits;
+    stats[1] = plans.misses;
+}
+
+bool decode_errata(void *rs, uint8_t a[], unsigned size, const unsigned erasures[], unsigned count) {
+    return bool(reinterpret_cast<context *>(rs)->rs0.decode_errata(a, size - RS0::ecc, a + size - RS0::ecc, erasures, count));
+}
+
+bool decode257_errata(void *rs, uint16_t a[], unsigned size, const unsigned erasures[], unsigned count) {
+    return bool(reinterpret_cast<context *>(rs)->rs1.decode_errata(a, size - RS1::ecc, a + size - RS1::ecc, erasures, count));
+}
+
+void ec8_encode(void *, uint8_t a[], unsigned len) {
+    uint8_t *frags[EC8::k + EC8::m];
+    ec_fragments<EC8>(frags, a, len);
+    EC8::encode(frags, &frags[EC8::k], len);
+}
+
+bool ec8_reconstruct(void *, uint8_t a[], unsigned len, const unsigned erased[], unsigned count) {
+    uint8_t *frags[EC8::k + EC8::m];
+    ec_fragments<EC8>(frags, a, len);
+    return EC8::reconstruct(frags, erased, count, len);
+}
+
+void ec64k_encode(void *, uint16_t a[], unsigned len) {
+    uint16_t *frags[EC64k::k + EC64k::m];
+    ec_fragments<EC64k>(frags, a, len);
+    EC64k::encode(frags, &frags[EC64k::k], len);
+}
+
+bool ec64k_reconstruct(void *, uint16_t a[], unsigned len, const unsigned erased[], unsigned count) {
+    uint16_t *frags[EC64k::k + EC64k::m];
+    ec_fragments<EC64k>(frags, a, len);
+    return EC64k::reconstruct(frags, erased, count, len);
+}
+
+uint64_t bch63_generator(void *, unsigned t) {
+    return t == 3 ? bch_generator<BCH63_45>::sdata.generator[0] : bch_generator<BCH63_30>::sdata.generator[0];
+}
+
+// policy 0 is bch_synds_basic, 1 bch_synds_minpoly, 2 bch_synds_remainder
+bool bch63_synds(void *, unsigned t, const uint8_t a[8], uint8_t synds[12], unsigned policy) {
+    if (t == 3) {
+        return policy == 0 ? bch_synds_with<bch_synds_basic<BCH63_45>>(a, synds)
+                : policy == 1 ? bch_synds_with<bch_synds_minpoly<BCH63_45>>(a, synds)
+                : bch_synds_with<bch_synds_remainder<BCH63_45>>(a, synds);
+    } else {
+        return policy == 0 ? bch_synds_with<bch_synds_basic<BCH63_30>>(a, synds)
+                : policy == 1 ? bch_synds_with<bch_synds_minpoly<BCH63_30>>(a, synds)
+                : bch_synds_with<bch_synds_remainder<BCH63_30>>(a, synds);
+    }
+}
+
+void bch63_45_encode(void *, uint8_t a[8]) {
+    BCH63_45::encode(a);
+}
+
+bool bch63_45_check(void *, const uint8_t a[8]) {
+    return BCH63_45::check(a);
+}
+
+int bch63_45_decode(void *, uint8_t a[8]) {
+    return bch_decode_status<BCH63_45>(a);
+}
+
+void bch63_30_encode(void *, uint8_t a[8]) {
+    BCH63_30::encode(a);
+}
+
+bool bch63_30_check(void *, const uint8_t a[8]) {
+    return BCH63_30::check(a);
+}
+
+int bch63_30_decode(void *, uint8_t a[8]) {
+    return bch_decode_status<BCH63_30>(a);
+}
+
+unsigned bch63_decode_batch(void *, unsigned t, uint8_t a[], unsigned count, int status[]) {
+    return t == 3 ? bch_decode_batch_status<BCH63_45>(a, count, status) : bch_decode_batch_status<BCH63_30>(a, count, status);
+}
+
+// op 0 encodes, 1 checks, 2 decodes
+int bch_long(void *, unsigned code, unsigned op, uint8_t a[]) {
+    switch (code) {
+    case 0: return bch_long_op<BCH4616_40>(op, a);
+    case 1: return bch_long_op<BCH4616_40_ref>(op, a);
+    case 2: return bch_long_op<BCH17464_72>(op, a);
+    default: return bch_long_op<BCH8191_8>(op, a);
+    }
+}
+
 }
@@ -1,167 +1,76 @@
-#include <chrono>
+#include <algorithm>
 #include <cstdio>
-#include <iostream>
 #include <random>
-#include <type_traits>
+#include <string>
+#include <vector>
 
+#include "bench.hpp"
 #include "reed_solomon.hpp"
 
 std::mt19937_64 mersenne;
-using hrc = std::chrono::high_resolution_clock;
 
-template<typename T, auto M = 256>
-void fill_random(T buf[], unsigned size) {
-    for (unsigned i = 0; i < size; ++i)
-        buf[i] = mersenne() % M;
-}
-
-void benchmark_enc_dec() {
-    std::cout << "benchmark_enc_dec" << std::endl;
-
-    const unsigned ecclen = 8;
-    const unsigned msglen = 255-ecclen;
-    const unsigned errors = 4;
-
-    uint8_t buffer[msglen + ecclen];
-    uint8_t err_pos[ecclen];
-
-    using GF = ::GF<uint8_t, 2, 8, 2, uint8_t(0x11d), gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
-    using RS = ::RS<GF, ecclen, rs_encode_slice<uint64_t, 16>::type, rs_synds_lut8, rs_roots_eval_chien, rs_decode>;
-
-    std::cout << "sizeof(RS<" << ecclen << ">) = " << sizeof(RS) << std::endl;
-    std::cout << "GF::static_data_size: " << GF::static_data_size << std::endl;
-    std::cout << "RS::static_data_size: " << RS::static_data_size << std::endl;
-
-    size_t processed = 0;
-    auto t_enc = hrc::duration(0);
-    auto t_dec = hrc::duration(0);
+using GF256 = GF<uint8_t, 2, 8, 2, 0x11d & 0xff, gf_add_xor, gf_exp_log_lut, gf_mul_exp_log_lut>;
+using GF257 = GF<uint16_t, 257, 1, 3, 0, gf_add_ring, gf_mul_cpu, gf_exp_log_lut>;
 
-    auto start = hrc::now();
-    while (hrc::now() - start < std::chrono::seconds(2)) {
-        fill_random(buffer, msglen + ecclen);
-
-        {
-            auto start = hrc::now();
-            RS::encode(buffer + msglen, buffer, msglen);
-            t_enc += hrc::now() - start;
-        }
-
-        uint8_t buffer2[msglen + ecclen];
-        std::copy_n(buffer, msglen + ecclen, buffer2);
-
-        // errors
-        for (unsigned i = 0; i < errors; ++i) {
-            unsigned pos;
-            do
-                pos = mersenne() % (msglen + ecclen);
-            while (std::find(err_pos, err_pos + i, pos) != (err_pos + i));
-
-            err_pos[i] = pos;
-            buffer[pos] ^= mersenne();
-        }
+template<unsigned Ecc, template<class>typename Enc>
+void sweep_encode(std::vector<bench::record>& out, bench::options const& opt, const char *name) {
+    using RS = ::RS<GF256, Ecc, Enc, rs_synds_lut8, rs_roots_eval_chien64, rs_decode>;
 
-        {
-            auto start = hrc::now();
-            RS::decode(&buffer[0], msglen, &buffer[msglen]);
-            // RS::decode(&buffer[0], msglen, &buffer[msglen], err_pos, errors);
-            t_dec += hrc::now() - start;
-        }
-
-        if (! std::equal(buffer, buffer + msglen + ecclen, buffer2)) {
-            std::printf("exp: ");
-            for (unsigned i = 0; i < msglen + ecclen; ++i)
-                std::printf("%02x ", buffer2[i]);
-            std::printf("\n");
-            std::printf("got: ");
-            for (unsigned i = 0; i < msglen + ecclen; ++i)
-                std::printf("%02x ", buffer[i]);
-            std::printf("\n");
-            assert(false);
-        }
-        processed += msglen;
-    }
-
-    auto enc_tp = processed / (t_enc.count() / 1e9);
-    auto dec_tp = processed / (t_dec.count() / 1e9);
-
-    std::cout << "encode: " << (enc_tp / 1e6) << " MB/s" << std::endl;
-    std::cout << "decode: " << (dec_tp / 1e6) << " MB/s" << std::endl;
+    for (unsigned msglen : {32u, 128u, 255u - Ecc})
+        bench::run_encode<RS>(out, opt, name, msglen);
 }
 
-void benchmark_enc_257() {
-    std::cout << "benchmark_enc_257" << std::endl;
-
-    const unsigned ecclen = 8;
-    const unsigned msglen = 256-ecclen;
-    const unsigned errors = 8;
-
-    uint16_t buffer[msglen + ecclen];
-    unsigned err_pos[ecclen];
-
-    using GF = ::GF<uint16_t, 257, 1, 3, 0, gf_add_ring, gf_mul_cpu, gf_exp_log_lut>;
-    using RS = ::RS<GF, ecclen, rs_encode_basic, rs_synds_basic, rs_roots_eval_basic, rs_decode>;
-
-    std::cout << "sizeof(RS<" << ecclen << ">) = " << sizeof(RS) << std::endl;
-    std::cout << "GF::static_data_size: " << GF::static_data_size << std::endl;
-    std::cout << "RS::static_data_size: " << RS::static_data_size << std::endl;
-
-    size_t processed = 0;
-    auto t_enc = hrc::duration(0);
-    auto t_dec = hrc::duration(0);
-
-    auto start = hrc::now();
-    while (hrc::now() - start < std::chrono::seconds(2)) {
-        fill_random(buffer, msglen + ecclen);
+template<unsigned Ecc, template<class>typename Synds, template<class>typename Roots>
+void sweep_decode(std::vector<bench::record>& out, bench::options const& opt, std::string const& name) {
+    using RS = ::RS<GF256, Ecc, rs_encode_lut, Synds, Roots, rs_decode>;
 
-        {
-            auto start = hrc::now();
-            RS::encode(buffer + msglen, buffer, msglen);
-            t_enc += hrc::now() - start;
-        }
-
-        uint16_t buffer2[msglen + ecclen];
-        std::copy_n(buffer, msglen + ecclen, buffer2);
-
-
-        // errors
-        for (unsigned i = 0; i < errors; ++i) {
-            unsigned pos;
-            do
-                pos = mersenne() % (msglen + ecclen);
-            while (std::find(err_pos, err_pos + i, pos) != (err_pos + i));
+    // Ecc / 4 collapses onto 0 or 1 for small ecc, so dedupe the counts rather than skip them
+    std::vector<unsigned> counts{0u, 1u, Ecc / 4, Ecc / 2};
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
 
-            err_pos[i] = pos;
-            buffer[pos] ^= mersenne();
-        }
+    for (unsigned msglen : {64u, 255u - Ecc})
+        for (unsigned errors : counts)
+            bench::run_decode<RS>(out, opt, name, msglen, errors);
+}
 
-        {
-            auto start = hrc::now();
-            // RS::decode(&buffer[0], msglen, &buffer[msglen]);
-            RS::decode(&buffer[0], msglen, &buffer[msglen], err_pos, errors);
-            t_dec += hrc::now() - start;
-        }
+template<unsigned Ecc, template<class>typename Synds>
+void sweep_roots(std::vector<bench::record>& out, bench::options const& opt, std::string const& synds) {
+    sweep_decode<Ecc, Synds, rs_roots_eval_basic>(out, opt, synds + "/basic");
+    sweep_decode<Ecc, Synds, rs_roots_eval_chien>(out, opt, synds + "/chien");
+    sweep_decode<Ecc, Synds, rs_roots_eval_chien64>(out, opt, synds + "/chien64");
+    sweep_decode<Ecc, Synds, rs_roots_eval_lut4>(out, opt, synds + "/lut4");
+    sweep_decode<Ecc, Synds, rs_roots_eval_lut8>(out, opt, synds + "/lut8");
+    sweep_decode<Ecc, Synds, rs_roots_direct_t<rs_roots_eval_chien64>::type>(out, opt, synds + "/direct");
+}
 
-        if (! std::equal(buffer, buffer + msglen + ecclen, buffer2)) {
-            std::printf("exp: ");
-            for (unsigned i = 0; i < msglen + ecclen; ++i)
-                std::printf("%02x ", buffer2[i]);
-            std::printf("\n");
-            std::printf("got: ");
-            for (unsigned i = 0; i < msglen + ecclen; ++i)
-                std::printf("%02x ", buffer[i]);
-            std::printf("\n");
-            assert(false);
-        }
-        processed += msglen;
-    }
+template<unsigned Ecc>
+void sweep(std::vector<bench::record>& out, bench::options const& opt) {
+    sweep_encode<Ecc, rs_encode_basic>(out, opt, "basic");
+    sweep_encode<Ecc, rs_encode_lut>(out, opt, "lut");
+    if constexpr (Ecc == 4)
+        sweep_encode<Ecc, rs_encode_slice<uint32_t, 8>::type>(out, opt, "slice8");
+    if constexpr (Ecc == 8)
+        sweep_encode<Ecc, rs_encode_slice<uint64_t, 16>::type>(out, opt, "slice16");
+
+    sweep_roots<Ecc, rs_synds_basic>(out, opt, "basic");
+    sweep_roots<Ecc, rs_synds_lut4>(out, opt, "lut4");
+    sweep_roots<Ecc, rs_synds_lut8>(out, opt, "lut8");
+}
 
-    auto enc_tp = processed / (t_enc.count() / 1e9);
-    auto dec_tp = processed / (t_dec.count() / 1e9);
+void sweep_257(std::vector<bench::record>& out, bench::options const& opt) {
+    using RS = ::RS<GF257, 8, rs_encode_basic, rs_synds_basic, rs_roots_eval_chien32, rs_decode>;
 
-    std::cout << "encode: " << (enc_tp / 1e6) << " MB/s" << std::endl;
-    std::cout << "decode: " << (dec_tp / 1e6) << " MB/s" << std::endl;
+    bench::run_encode<RS>(out, opt, "gf257/basic", 248);
+    for (unsigned errors : {0u, 1u, 4u})
+        bench::run_decode<RS>(out, opt, "gf257/basic/chien32", 248, errors);
 }
 
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+            "usage: %s [--time seconds] [--batch n] [--format text|csv|json] [--output file]\n"
+            "          [--baseline file.csv] [--filter substring]\n", argv0);
+}
 
 void test_bit_array() {
     constexpr auto arr_size = 10000;
@@ -194,9 +103,67 @@ int main(int argc, char *argv[]) {
 
     // test_bit_array();
 
-    mersenne.seed(42);
-    benchmark_enc_dec();
-    benchmark_enc_257();
+    bench::options opt;
+    std::string format = "text";
+    std::string output;
+    std::string baseline;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (arg == "--time")
+            opt.seconds = std::stod(argv[++i]);
+        else if (arg == "--batch")
+            opt.batch = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--format") {
+            format = argv[++i];
+            if (format != "text" && format != "csv" && format != "json") {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "--output")
+            output = argv[++i];
+        else if (arg == "--baseline")
+            baseline = argv[++i];
+        else if (arg == "--filter")
+            opt.filter = argv[++i];
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<bench::record> records;
+    sweep<4>(records, opt);
+    sweep<8>(records, opt);
+    sweep<16>(records, opt);
+    sweep_257(records, opt);
+
+    if (!baseline.empty() && !bench::apply_baseline(records, baseline)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", baseline.c_str());
+        return 2;
+    }
+
+    std::FILE *f = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+    if (!f) {
+        std::fprintf(stderr, "cannot write %s\n", output.c_str());
+        return 2;
+    }
+
+    if (format == "csv")
+        bench::write_csv(f, records);
+    else if (format == "json")
+        bench::write_json(f, records);
+    else
+        bench::write_text(f, records);
+
+    if (f != stdout)
+        std::fclose(f);
 
-    return 0;
+    bool failed = std::any_of(records.begin(), records.end(), [](auto& r) { return r.failures != 0; });
+    return failed ? 1 : 0;
 }
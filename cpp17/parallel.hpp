@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace detail {
+    // Half-open range of work items packed as (end << 32 | begin) so the owner taking from the
+    // front and thieves taking from the back only ever need a single CAS.
+    struct alignas(64) work_range {
+        std::atomic<uint64_t> packed{0};
+        size_t total = 0;
+
+        static constexpr uint64_t pack(uint32_t begin, uint32_t end) {
+            return (uint64_t(end) << 32) | begin;
+        }
+
+        void assign(uint32_t begin, uint32_t end) {
+            packed.store(pack(begin, end), std::memory_order_release);
+        }
+
+        bool pop(unsigned grain, uint32_t& begin, uint32_t& end) {
+            uint64_t cur = packed.load(std::memory_order_acquire);
+
+            for (;;) {
+                uint32_t b = uint32_t(cur), e = uint32_t(cur >> 32);
+                if (b >= e)
+                    return false;
+
+                uint32_t n = std::min<uint32_t>(b + grain, e);
+                if (packed.compare_exchange_weak(cur, pack(n, e), std::memory_order_acq_rel)) {
+                    begin = b;
+                    end = n;
+                    return true;
+                }
+            }
+        }
+
+        bool steal(uint32_t& begin, uint32_t& end) {
+            uint64_t cur = packed.load(std::memory_order_acquire);
+
+            for (;;) {
+                uint32_t b = uint32_t(cur), e = uint32_t(cur >> 32);
+                if (b >= e)
+                    return false;
+
+                uint32_t mid = b + (e - b) / 2;
+                if (packed.compare_exchange_weak(cur, pack(b, mid), std::memory_order_acq_rel)) {
+                    begin = mid;
+                    end = e;
+                    return true;
+                }
+            }
+        }
+    };
+}
+
+// Persistent pool of worker threads. Each job is split evenly across threads up front;
+// a thread that runs out of work steals the upper half of another thread's remaining range.
+// The calling thread takes part as thread 0, and dispatching a job does not allocate.
+class rs_thread_pool {
+public:
+    explicit rs_thread_pool(unsigned threads = std::thread::hardware_concurrency(), bool pin = false)
+            : ranges(std::max(threads, 1u)) {
+        for (unsigned i = 1; i < ranges.size(); ++i)
+            workers.emplace_back([this, i] { worker(i); });
+
+        if (pin) {
+            for (unsigned i = 1; i < ranges.size(); ++i)
+                pin_thread(workers[i - 1].native_handle(), i);
+        }
+    }
+
+    ~rs_thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto& w : workers)
+            w.join();
+    }
+
+    rs_thread_pool(rs_thread_pool const&) = delete;
+    rs_thread_pool& operator=(rs_thread_pool const&) = delete;
+
+    inline unsigned size() const {
+        return unsigned(ranges.size());
+    }
+
+    // Calls fn(begin, end, thread) over [0, items) in chunks of at most `grain` items and returns
+    // the sum of whatever fn returns. Jobs are serialized: concurrent callers wait for each other.
+    template<typename F>
+    size_t run(uint32_t items, unsigned grain, F&& fn) {
+        if (items == 0)
+            return 0;
+
+        std::lock_guard<std::mutex> job_lock(job_mutex);
+        const unsigned threads = size();
+
+        for (unsigned t = 0; t < threads; ++t) {
+            ranges[t].assign(uint32_t(uint64_t(items) * t / threads),
+                    uint32_t(uint64_t(items) * (t + 1) / threads));
+            ranges[t].total = 0;
+        }
+
+        job_fn = [](void *ctx, uint32_t begin, uint32_t end, unsigned thread) -> size_t {
+            auto& f = *static_cast<std::remove_reference_t<F> *>(ctx);
+            if constexpr (std::is_void_v<decltype(f(begin, end, thread))>) {
+                f(begin, end, thread);
+                return 0;
+            } else {
+                return size_t(f(begin, end, thread));
+            }
+        };
+        job_ctx = &fn;
+        job_grain = std::max(grain, 1u);
+
+        if (threads > 1) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                active = threads - 1;
+                ++generation;
+            }
+            wake.notify_all();
+        }
+
+        work(0);
+
+        if (threads > 1) {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return active == 0; });
+        }
+
+        size_t total = 0;
+        for (auto& r : ranges)
+            total += r.total;
+
+        return total;
+    }
+
+private:
+    std::vector<detail::work_range> ranges;
+    std::vector<std::thread> workers;
+
+    std::mutex job_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    unsigned active = 0;
+    bool stopping = false;
+
+    size_t (*job_fn)(void *, uint32_t, uint32_t, unsigned) = nullptr;
+    void *job_ctx = nullptr;
+    unsigned job_grain = 1;
+
+    void work(unsigned thread) {
+        const unsigned threads = size();
+        uint32_t begin, end;
+
+        for (;;) {
+            while (ranges[thread].pop(job_grain, begin, end))
+                ranges[thread].total += job_fn(job_ctx, begin, end, thread);
+
+            bool stolen = false;
+            for (unsigned k = 1; k < threads && !stolen; ++k) {
+                if (ranges[(thread + k) % threads].steal(begin, end)) {
+                    ranges[thread].assign(begin, end);
+                    stolen = true;
+                }
+            }
+
+            if (!stolen)
+                return;
+        }
+    }
+
+    void worker(unsigned thread) {
+        uint64_t seen = 0;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            work(thread);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0)
+                done.notify_one();
+        }
+    }
+
+#ifdef __linux__
+    static inline void pin_thread(pthread_t handle, unsigned thread) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(thread % std::max(std::thread::hardware_concurrency(), 1u), &set);
+        pthread_setaffinity_np(handle, sizeof(set), &set);
+    }
+#else
+    template<typename H>
+    static inline void pin_thread(H, unsigned) {}
+#endif
+};
+
+// Codewords of size + ecc symbols stored back to back, as in RS::decode_batch.
+template<typename RS, typename T>
+inline void rs_parallel_encode(rs_thread_pool& pool, T data, uint32_t blocks, unsigned size, unsigned grain = 64) {
+    const unsigned stride = size + RS::ecc;
+
+    pool.run(blocks, grain, [&](uint32_t begin, uint32_t end, unsigned) {
+        for (uint32_t i = begin; i < end; ++i)
+            RS::encode(&data[size_t(i) * stride + size], &data[size_t(i) * stride], size);
+    });
+}
+
+// Returns the number of blocks that could not be decoded.
+template<typename RS, typename T>
+inline size_t rs_parallel_decode(rs_thread_pool& pool, T data, uint32_t blocks, unsigned size,
+        typename RS::result results[] = nullptr) {
+    const unsigned stride = size + RS::ecc;
+
+    return pool.run(blocks, RS::batch_chunk, [&](uint32_t begin, uint32_t end, unsigned) {
+        return RS::decode_batch(&data[size_t(begin) * stride], end - begin, size,
+                results ? &results[begin] : nullptr);
+    });
+}
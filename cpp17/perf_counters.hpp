@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Hardware counters around a code region, opened through perf_event_open as one group so
+// every value covers the same interval. Counters the kernel or the PMU refuses (virtual
+// machines, perf_event_paranoid) are reported as unavailable; if not even the cycle counter
+// can be opened, cycles come from the TSC, which ticks at the reference clock rather than the
+// core clock.
+class perf_counters {
+public:
+    enum counter { cycles, instructions, l1d_misses, branch_misses, counter_count };
+
+    struct sample {
+        uint64_t value[counter_count] = {};
+        bool valid[counter_count] = {};
+        bool tsc = false;           // cycles from the time stamp counter
+        double ns = 0;
+
+        inline double per(counter c, double ops) const { return valid[c] ? double(value[c]) / ops : -1; }
+        inline double ipc() const {
+            return valid[cycles] && valid[instructions] && !tsc && value[cycles]
+                    ? double(value[instructions]) / double(value[cycles]) : -1;
+        }
+    };
+
+    perf_counters() {
+#ifdef __linux__
+        static const struct { uint32_t type; uint64_t config; } events[counter_count] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                    | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+
+        for (unsigned c = 0; c < counter_count; ++c) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[c].type;
+            attr.config = events[c].config;
+            attr.disabled = fds[cycles] < 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+
+            fds[c] = int(syscall(SYS_perf_event_open, &attr, 0, -1, fds[cycles], 0));
+            if (fds[c] >= 0)
+                ioctl(fds[c], PERF_EVENT_IOC_ID, &ids[c]);
+            else if (c == cycles)
+                break;
+        }
+#endif
+    }
+
+    ~perf_counters() {
+#ifdef __linux__
+        for (auto fd : fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    perf_counters(perf_counters const&) = delete;
+    perf_counters& operator=(perf_counters const&) = delete;
+
+    inline bool hardware() const { return fds[cycles] >= 0; }
+
+    inline void start() {
+#ifdef __linux__
+        if (hardware()) {
+            ioctl(fds[cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+        t0 = std::chrono::steady_clock::now();
+        tsc0 = read_tsc();
+    }
+
+    inline sample stop() {
+        auto tsc1 = read_tsc();
+        auto t1 = std::chrono::steady_clock::now();
+        sample s;
+
+#ifdef __linux__
+        if (hardware()) {
+            ioctl(fds[cycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            struct { uint64_t nr; struct { uint64_t value, id; } v[counter_count]; } data = {};
+            if (read(fds[cycles], &data, sizeof(data)) > 0) {
+                for (uint64_t i = 0; i < data.nr && i < counter_count; ++i) {
+                    for (unsigned c = 0; c < counter_count; ++c) {
+                        if (fds[c] >= 0 && ids[c] == data.v[i].id) {
+                            s.value[c] = data.v[i].value;
+                            s.valid[c] = true;
+                        }
+                    }
+                }
+            }
+        }
+#endif
+
+        if (!s.valid[cycles]) {
+            s.value[cycles] = tsc1 - tsc0;
+            s.valid[cycles] = tsc1 != tsc0;
+            s.tsc = true;
+        }
+
+        s.ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        return s;
+    }
+
+private:
+    int fds[counter_count] = {-1, -1, -1, -1};
+    uint64_t ids[counter_count] = {};
+    std::chrono::steady_clock::time_point t0;
+    uint64_t tsc0 = 0;
+
+    static inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+};
@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "file_protect.hpp"
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+            "usage: %s encode|verify|repair <file> [-p parity] [-e ecc] [-i interleave] [-t threads]\n"
+            "  -p parity      sidecar parity file (default: <file>.rs)\n"
+            "  -e ecc         parity symbols per codeword: 2, 4, 8, 16 or 32 (default: 8)\n"
+            "  -i interleave  codewords per stripe, 1 to %u (default: 16)\n"
+            "  -t threads     worker threads (default: all cores)\n"
+            "exit status: 0 clean or repaired, 1 damage found or unrepairable, 2 usage or I/O error\n",
+            argv0, rs_file_header::max_interleave);
+}
+
+static const char *status_name(rs_file_status status) {
+    switch (status) {
+    case rs_file_status::ok:            return "ok";
+    case rs_file_status::io_error:      return "I/O error";
+    case rs_file_status::bad_header:    return "bad parity file header";
+    case rs_file_status::unsupported:   return "unsupported parameters";
+    case rs_file_status::size_mismatch: return "file size does not match parity file";
+    case rs_file_status::uncorrectable: return "uncorrectable damage";
+    }
+    return "unknown";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string mode = argv[1];
+    const char *path = argv[2];
+    std::string parity_path = std::string(path) + ".rs";
+    unsigned ecc = 8;
+    unsigned interleave = 16;
+    unsigned threads = std::thread::hardware_concurrency();
+
+    for (int i = 3; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (!std::strcmp(argv[i], "-p"))
+            parity_path = argv[++i];
+        else if (!std::strcmp(argv[i], "-e"))
+            ecc = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "-i"))
+            interleave = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "-t"))
+            threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    rs_thread_pool pool(threads);
+    rs_file_report report;
+
+    if (mode == "encode")
+        report = rs_file_protect(pool, path, parity_path.c_str(), ecc, interleave);
+    else if (mode == "verify" || mode == "repair")
+        report = rs_file_verify(pool, path, parity_path.c_str(), mode == "repair");
+    else {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const char *status = status_name(report.status);
+    if (report.status == rs_file_status::ok && report.corrected)
+        status = (mode == "repair") ? "repaired" : "damaged, repairable";
+
+    std::printf("%s: %s\n", path, status);
+    std::printf("codewords: %llu clean: %llu corrected symbols: %llu failed: %llu\n",
+            (unsigned long long) report.codewords, (unsigned long long) report.clean,
+            (unsigned long long) report.corrected, (unsigned long long) report.failed);
+
+    switch (report.status) {
+    case rs_file_status::ok:
+        return (mode == "verify" && report.corrected) ? 1 : 0;
+    case rs_file_status::uncorrectable:
+        return 1;
+    default:
+        return 2;
+    }
+}
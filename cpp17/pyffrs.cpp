@@ -0,0 +1,262 @@
+// Python extension for batch coding of GF(2^8) Reed-Solomon codewords.
+//
+//   ffrs.encode(buf, ecc=8, row=None, out=None) -> out
+//   ffrs.decode(buf, ecc=8, row=None, positions=False) -> bytes or (bytes, bytes)
+//   ffrs.check(buf, ecc=8, row=None, out=None, positions=False) -> bytes or (bytes, bytes)
+//
+// buf is any C-contiguous buffer of bytes (bytes, bytearray, memoryview, 2-D uint8 numpy
+// array, ...) holding back-to-back codewords of `row` bytes, the last `ecc` of which are
+// parity. For 2-D buffers `row` defaults to the row length. All calls release the GIL.
+//
+// encode and check only read buf, so it may be read-only. They write the codewords to `out`, a
+// writable buffer of the same length, or to a new bytearray that encode returns and check
+// drops. encode(buf, out=buf) writes the parity in place; decode repairs a writable buf in place.
+//
+// decode and check return one signed byte per row: the number of corrected symbols, or minus
+// the rs_decode_result status when the row could not be decoded. With positions=True they also
+// return `ecc` bytes per row: the codeword indices of the corrected symbols, padded with 0xff.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "file_protect.hpp"
+#include "parallel.hpp"
+
+static rs_thread_pool& pool() {
+    static rs_thread_pool p;
+    return p;
+}
+
+struct batch_args {
+    Py_buffer view = {};
+    Py_buffer out_view = {};
+    unsigned ecc = 8;
+    unsigned row = 0;
+    uint32_t rows = 0;
+    int positions = 0;
+
+    ~batch_args() {
+        if (view.obj)
+            PyBuffer_Release(&view);
+        if (out_view.obj)
+            PyBuffer_Release(&out_view);
+    }
+};
+
+// Accepts what the "y*" (or, if writable, "w*") converter does, but also asks for the shape so
+// that 2-D arrays give the default row length
+static bool get_bytes(PyObject *obj, Py_buffer& view, bool writable) {
+    if (PyObject_GetBuffer(obj, &view, PyBUF_ND | (writable ? PyBUF_WRITABLE : 0)) != 0)
+        return false;
+
+    if (!PyBuffer_IsContiguous(&view, 'C') || view.itemsize != 1) {
+        PyErr_SetString(PyExc_ValueError, "buffer must be C-contiguous bytes");
+        return false;
+    }
+
+    return true;
+}
+
+static bool parse_batch(PyObject *buf, PyObject *row, PyObject *out, bool writable, batch_args& a) {
+    if (!get_bytes(buf, a.view, writable))
+        return false;
+
+    if (!rs_file_ecc_supported(a.ecc)) {
+        PyErr_SetString(PyExc_ValueError, "ecc must be 2, 4, 8, 16 or 32");
+        return false;
+    }
+
+    if (row != Py_None) {
+        auto r = PyLong_AsUnsignedLong(row);
+        if (PyErr_Occurred())
+            return false;
+        a.row = unsigned(r);
+    } else if (a.view.ndim == 2) {
+        a.row = unsigned(a.view.shape[1]);
+    } else {
+        a.row = 255;
+    }
+
+    if (a.row <= a.ecc || a.row > 255) {
+        PyErr_SetString(PyExc_ValueError, "row must be larger than ecc and at most 255");
+        return false;
+    }
+
+    if (a.view.len % a.row != 0 || a.view.len / a.row > UINT32_MAX) {
+        PyErr_SetString(PyExc_ValueError, "buffer length must be a multiple of row");
+        return false;
+    }
+
+    a.rows = uint32_t(a.view.len / a.row);
+
+    if (out != Py_None) {
+        if (!get_bytes(out, a.out_view, true))
+            return false;
+
+        if (a.out_view.len != a.view.len) {
+            PyErr_SetString(PyExc_ValueError, "out must be as long as buf");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Copies buf into the output buffer, or into a new bytearray when none was given. Returns a new
+// reference to the output object.
+static PyObject *output_of(batch_args& a, uint8_t *& data) {
+    PyObject *out;
+
+    if (a.out_view.obj) {
+        out = a.out_view.obj;
+        Py_INCREF(out);
+        data = static_cast<uint8_t *>(a.out_view.buf);
+        if (data != a.view.buf)
+            std::memmove(data, a.view.buf, size_t(a.view.len));
+    } else {
+        out = PyByteArray_FromStringAndSize(static_cast<const char *>(a.view.buf), a.view.len);
+        if (!out)
+            return nullptr;
+        data = reinterpret_cast<uint8_t *>(PyByteArray_AS_STRING(out));
+    }
+
+    return out;
+}
+
+static PyObject *decode_rows(batch_args& a, uint8_t *data) {
+    PyObject *out = PyBytes_FromStringAndSize(nullptr, Py_ssize_t(a.rows));
+    PyObject *pos = a.positions ? PyBytes_FromStringAndSize(nullptr, Py_ssize_t(a.rows) * a.ecc) : nullptr;
+    if (!out || (a.positions && !pos)) {
+        Py_XDECREF(out);
+        Py_XDECREF(pos);
+        return nullptr;
+    }
+
+    auto status = reinterpret_cast<int8_t *>(PyBytes_AS_STRING(out));
+    auto positions = pos ? reinterpret_cast<uint8_t *>(PyBytes_AS_STRING(pos)) : nullptr;
+    bool nomem = false;
+
+    Py_BEGIN_ALLOW_THREADS
+    detail::rs_file_dispatch(a.ecc, [&](auto codec) {
+        using RS = typename decltype(codec)::RS;
+        std::unique_ptr<typename RS::result[]> results(new (std::nothrow) typename RS::result[a.rows]);
+
+        if (!results) {
+            nomem = true;
+            return;
+        }
+
+        rs_parallel_decode<RS>(pool(), data, a.rows, a.row - RS::ecc, results.get());
+
+        for (uint32_t i = 0; i < a.rows; ++i) {
+            auto& r = results[i];
+            status[i] = r ? int8_t(r.corrected) : -int8_t(r.status);
+
+            if (positions) {
+                auto row = &positions[size_t(i) * RS::ecc];
+                unsigned n = r ? r.corrected : 0;
+                for (unsigned j = 0; j < RS::ecc; ++j)
+                    row[j] = j < n ? uint8_t(r.positions[j]) : 0xff;
+            }
+        }
+    });
+    Py_END_ALLOW_THREADS
+
+    if (nomem) {
+        Py_DECREF(out);
+        Py_XDECREF(pos);
+        return PyErr_NoMemory();
+    }
+
+    if (!pos)
+        return out;
+
+    PyObject *pair = PyTuple_Pack(2, out, pos);
+    Py_DECREF(out);
+    Py_DECREF(pos);
+    return pair;
+}
+
+static PyObject *ffrs_encode(PyObject *, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"buf", "ecc", "row", "out", nullptr};
+    batch_args a;
+    PyObject *buf, *row = Py_None, *out = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|IOO", const_cast<char **>(keywords),
+                &buf, &a.ecc, &row, &out) || !parse_batch(buf, row, out, false, a))
+        return nullptr;
+
+    uint8_t *data;
+    PyObject *result = output_of(a, data);
+    if (!result)
+        return nullptr;
+
+    Py_BEGIN_ALLOW_THREADS
+    detail::rs_file_dispatch(a.ecc, [&](auto codec) {
+        using RS = typename decltype(codec)::RS;
+        rs_parallel_encode<RS>(pool(), data, a.rows, a.row - RS::ecc);
+    });
+    Py_END_ALLOW_THREADS
+
+    return result;
+}
+
+static PyObject *ffrs_decode(PyObject *, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"buf", "ecc", "row", "positions", nullptr};
+    batch_args a;
+    PyObject *buf, *row = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|IOp", const_cast<char **>(keywords),
+                &buf, &a.ecc, &row, &a.positions) || !parse_batch(buf, row, Py_None, true, a))
+        return nullptr;
+
+    return decode_rows(a, static_cast<uint8_t *>(a.view.buf));
+}
+
+static PyObject *ffrs_check(PyObject *, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"buf", "ecc", "row", "out", "positions", nullptr};
+    batch_args a;
+    PyObject *buf, *row = Py_None, *out = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|IOOp", const_cast<char **>(keywords),
+                &buf, &a.ecc, &row, &out, &a.positions) || !parse_batch(buf, row, out, false, a))
+        return nullptr;
+
+    uint8_t *data;
+    PyObject *copy = output_of(a, data);
+    if (!copy)
+        return nullptr;
+
+    PyObject *result = decode_rows(a, data);
+    Py_DECREF(copy);
+    return result;
+}
+
+static PyMethodDef ffrs_methods[] = {
+    {"encode", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(ffrs_encode)),
+            METH_VARARGS | METH_KEYWORDS, "encode(buf, ecc=8, row=None, out=None) -> out\n\n"
+            "Write buf with the parity of every row to out, or to a new bytearray. "
+            "out=buf encodes in place."},
+    {"decode", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(ffrs_decode)),
+            METH_VARARGS | METH_KEYWORDS, "decode(buf, ecc=8, row=None, positions=False) -> bytes\n\n"
+            "Correct every row in place. Returns one signed byte per row: corrected symbols, "
+            "or -status if the row could not be decoded. With positions=True, returns "
+            "(status, positions) with ecc corrected indices per row, padded with 0xff."},
+    {"check", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(ffrs_check)),
+            METH_VARARGS | METH_KEYWORDS, "check(buf, ecc=8, row=None, out=None, positions=False) -> bytes\n\n"
+            "Like decode, but leaves buf untouched: the corrected rows go to out, if given."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef ffrs_module = {
+    PyModuleDef_HEAD_INIT, "ffrs", "Batch Reed-Solomon coding over GF(2^8)", -1, ffrs_methods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit_ffrs() {
+    return PyModule_Create(&ffrs_module);
+}
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 #include "galois.hpp"
 
@@ -82,34 +87,45 @@ struct rs_base {
     static constexpr auto ecc = Ecc;
 };
 
-template<typename RS>
-struct rs_generator {
-    static inline constexpr struct sdata_t {
-        using GFT = typename RS::GF::Repr;
+namespace detail {
+    // Generator and its roots depend only on the field and ecc, keyed on the canonical field
+    // so that codecs differing only in policies share them
+    template<typename Field, unsigned Ecc>
+    struct rs_generator_data {
+        static inline constexpr struct sdata_t {
+            using GFT = typename Field::Repr;
 
-        GFT generator[RS::ecc + 1] = {};
-        GFT roots[RS::ecc] = {};
+            GFT generator[Ecc + 1] = {};
+            GFT roots[Ecc] = {};
 
-        inline constexpr sdata_t() {
-            GFT temp[RS::ecc + 1] = {};
+            inline constexpr sdata_t() {
+                GFT temp[Ecc + 1] = {};
 
-            auto p1 = (RS::ecc & 1) ? &generator[0] : &temp[0];
-            auto p2 = (RS::ecc & 1) ? &temp[0] : &generator[0];
+                auto p1 = (Ecc & 1) ? &generator[0] : &temp[0];
+                auto p2 = (Ecc & 1) ? &temp[0] : &generator[0];
 
-            unsigned len = 1;
-            p2[0] = 1;
+                unsigned len = 1;
+                p2[0] = 1;
 
-            for (unsigned i = 0; i < RS::ecc; ++i) {
-                roots[i] = RS::GF::exp(i);
-                GFT factor[] = {1, RS::GF::sub(0, roots[i])};
-                len = RS::GF::poly_mul(p1, p2, len, factor, 2);
+                for (unsigned i = 0; i < Ecc; ++i) {
+                    roots[i] = Field::exp(i);
+                    GFT factor[] = {1, Field::sub(0, roots[i])};
+                    len = Field::poly_mul(p1, p2, len, factor, 2);
 
-                auto t = p1;
-                p1 = p2;
-                p2 = t;
+                    auto t = p1;
+                    p1 = p2;
+                    p2 = t;
+                }
             }
-        }
-    } sdata{};
+        } sdata{};
+    };
+}
+
+template<typename RS>
+struct rs_generator {
+    using sdata_t = typename detail::rs_generator_data<detail::gf_canonical_t<typename RS::GF>, RS::ecc>::sdata_t;
+
+    static constexpr auto& sdata = detail::rs_generator_data<detail::gf_canonical_t<typename RS::GF>, RS::ecc>::sdata;
 };
 
 template<typename RS>
@@ -227,6 +243,75 @@ struct rs_encode_slice {
     };
 };
 
+// Remainder tables for the high and low nibble of the feedback byte: 32 * ecc bytes instead of
+// the 256 * ecc of rs_encode_lut, at the cost of one more lookup per input byte
+template<typename RS>
+struct rs_encode_nibble {
+    static_assert(RS::GF::prime == 2 && RS::GF::power == 8);
+
+    static constexpr auto& generator = rs_generator<RS>::sdata.generator;
+
+    static inline constexpr struct sdata_t {
+        uint8_t lo[16][RS::ecc] = {};
+        uint8_t hi[16][RS::ecc] = {};
+
+        constexpr inline sdata_t() {
+            for (unsigned i = 0; i < 16; ++i) {
+                uint8_t data_lo[RS::ecc + 1] = {uint8_t(i)};
+                uint8_t data_hi[RS::ecc + 1] = {uint8_t(i << 4)};
+                RS::GF::ex_synth_div(&data_lo[0], RS::ecc + 1, &generator[0], RS::ecc + 1);
+                RS::GF::ex_synth_div(&data_hi[0], RS::ecc + 1, &generator[0], RS::ecc + 1);
+
+                for (unsigned j = 0; j < RS::ecc; ++j) {
+                    lo[i][j] = data_lo[j + 1];
+                    hi[i][j] = data_hi[j + 1];
+                }
+            }
+        }
+    } sdata{};
+
+    static inline void encode(uint8_t *output, const uint8_t *data, unsigned size) {
+        std::fill_n(output, RS::ecc, 0x00);
+        for (unsigned i = 0; i < size; ++i) {
+            uint8_t pos = output[0] ^ data[i];
+            auto lo = &sdata.lo[pos & 0xf][0];
+            auto hi = &sdata.hi[pos >> 4][0];
+
+            for (unsigned j = 0; j + 1 < RS::ecc; ++j)
+                output[j] = output[j + 1] ^ lo[j] ^ hi[j];
+            output[RS::ecc - 1] = lo[RS::ecc - 1] ^ hi[RS::ecc - 1];
+        }
+    }
+};
+
+namespace detail {
+    template<typename RS, size_t Budget>
+    struct rs_encode_budget_select {
+        static constexpr bool byte_field = RS::GF::prime == 2 && RS::GF::power == 8;
+        static constexpr bool sliceable = byte_field && (RS::ecc == 4 || RS::ecc == 8);
+        using word = std::conditional_t<RS::ecc == 4, uint32_t, uint64_t>;
+
+        template<unsigned N>
+        static constexpr bool slice_fits = sliceable && N % RS::ecc == 0 && N * 256 * sizeof(word) <= Budget;
+
+        using type =
+            std::conditional_t<slice_fits<16>, typename rs_encode_slice<word, 16>::template type<RS>,
+            std::conditional_t<slice_fits<8>, typename rs_encode_slice<word, 8>::template type<RS>,
+            std::conditional_t<slice_fits<4>, typename rs_encode_slice<word, 4>::template type<RS>,
+            std::conditional_t<byte_field && 256 * RS::ecc <= Budget, rs_encode_lut<RS>,
+            std::conditional_t<byte_field && 32 * RS::ecc <= Budget, rs_encode_nibble<RS>,
+            rs_encode_basic<RS>>>>>>;
+    };
+}
+
+// Fastest encoder whose own tables fit in Budget bytes: slice-by-16/8/4, lut, nibble, then
+// the table-free rs_encode_basic
+template<size_t Budget>
+struct rs_encode_budget_t {
+    template<typename RS>
+    using type = typename detail::rs_encode_budget_select<RS, Budget>::type;
+};
+
 template<typename RS>
 struct rs_synds_basic {
     using GFT = typename RS::GF::Repr;
@@ -326,6 +411,96 @@ struct rs_roots_eval_chien {
     }
 };
 
+template<unsigned Block>
+struct rs_roots_eval_chien_t {
+    template<typename RS>
+    struct type {
+        using GFT = typename RS::GF::Repr;
+        static constexpr unsigned order = RS::GF::charact - 1;
+
+        static inline constexpr struct sdata_t {
+            // two periods of exp, so that sums of two reduced logs need no reduction
+            GFT exp[2 * order] = {};
+            // log of alpha^(-j*w) for the positions inside a block
+            uint32_t step[RS::ecc + 1][Block] = {};
+            // log of alpha^(-j*Block), advances a coefficient by one block
+            uint32_t stride[RS::ecc + 1] = {};
+
+            inline constexpr sdata_t() {
+                for (unsigned i = 0; i < 2 * order; ++i)
+                    exp[i] = RS::GF::exp(i % order);
+
+                for (unsigned j = 0; j < RS::ecc + 1; ++j) {
+                    for (unsigned w = 0; w < Block; ++w)
+                        step[j][w] = (order - (j * w) % order) % order;
+
+                    stride[j] = (order - (j * Block) % order) % order;
+                }
+            }
+        } sdata{};
+
+        static inline unsigned roots(
+                const GFT poly[], unsigned poly_size,
+                GFT roots[], unsigned size)
+        {
+            assert(poly_size <= RS::ecc + 1);
+
+            if (poly_size < 2)
+                return 0;
+
+            // evaluate poly(alpha^-p) in the log domain, one block of positions at a time
+            uint32_t coef_log[RS::ecc + 1];
+            unsigned coef_idx[RS::ecc + 1];
+            unsigned coefs = 0;
+
+            for (unsigned j = 1; j < poly_size; ++j) {
+                GFT c = poly[poly_size - 1 - j];
+                if (c == 0)
+                    continue;
+
+                coef_log[coefs] = RS::GF::log(c) % order;
+                coef_idx[coefs++] = j;
+            }
+
+            const GFT c0 = poly[poly_size - 1];
+            unsigned count = 0;
+
+            for (unsigned p = 0; p < size; p += Block) {
+                GFT eval[Block];
+                std::fill_n(eval, Block, c0);
+
+                for (unsigned k = 0; k < coefs; ++k) {
+                    auto step = &sdata.step[coef_idx[k]][0];
+                    auto base = coef_log[k];
+
+                    for (unsigned w = 0; w < Block; ++w)
+                        eval[w] = RS::GF::add(eval[w], sdata.exp[base + step[w]]);
+
+                    base += sdata.stride[coef_idx[k]];
+                    coef_log[k] = (base >= order) ? base - order : base;
+                }
+
+                for (unsigned w = 0; w < std::min(Block, size - p); ++w) {
+                    if (eval[w] == 0) {
+                        roots[count] = p + w;
+                        if (++count >= poly_size - 1)
+                            return count;
+                    }
+                }
+            }
+
+            return count;
+        }
+    };
+};
+
+template<typename RS>
+using rs_roots_eval_chien16 = rs_roots_eval_chien_t<16>::type<RS>;
+template<typename RS>
+using rs_roots_eval_chien32 = rs_roots_eval_chien_t<32>::type<RS>;
+template<typename RS>
+using rs_roots_eval_chien64 = rs_roots_eval_chien_t<64>::type<RS>;
+
 template<typename Word>
 struct rs_roots_eval_lut_t {
     template<typename RS>
@@ -374,179 +549,1154 @@ using rs_roots_eval_lut4 = rs_roots_eval_lut_t<uint32_t>::type<RS>;
 template<typename RS>
 using rs_roots_eval_lut8 = rs_roots_eval_lut_t<uint64_t>::type<RS>;
 
+template<template<class>typename Fallback>
+struct rs_roots_direct_t {
+    template<typename RS>
+    struct type {
+        using GFT = typename RS::GF::Repr;
+        static constexpr unsigned order = RS::GF::charact - 1;
+
+        static inline constexpr struct sdata_t {
+            // quad[c] = y such that y^2 + y = c, 0 if there is none (c != 0)
+            GFT quad[RS::GF::charact] = {};
+
+            inline constexpr sdata_t() {
+                if constexpr (RS::GF::prime == 2) {
+                    for (unsigned y = 0; y < RS::GF::charact; ++y)
+                        quad[RS::GF::add(RS::GF::mul(y, y), y)] = y;
+                }
+            }
+        } sdata{};
+
+        static inline unsigned roots(
+                const GFT poly[], unsigned poly_size,
+                GFT roots[], unsigned size)
+        {
+            if constexpr (RS::GF::prime == 2) {
+                if (poly_size >= 2 && poly_size <= 5 && poly[0] != 0) {
+                    GFT x[4];
+                    int n = solve(poly, poly_size, x);
+
+                    if (n >= 0)
+                        return positions(poly, poly_size, x, n, roots, size);
+                }
+            }
+
+            return Fallback<RS>::roots(poly, poly_size, roots, size);
+        }
+
+    private:
+        // keep the candidates that are roots of poly and map them to positions
+        static inline unsigned positions(
+                const GFT poly[], unsigned poly_size,
+                const GFT x[], unsigned n,
+                GFT roots[], unsigned size)
+        {
+            unsigned count = 0;
+
+            for (unsigned i = 0; i < n; ++i) {
+                if (x[i] == 0 || RS::GF::poly_eval(poly, poly_size, x[i]) != 0)
+                    continue;
+
+                unsigned pos = (order - RS::GF::log(x[i]) % order) % order;
+                if (pos >= size || std::find(&roots[0], &roots[count], pos) != &roots[count])
+                    continue;
+
+                roots[count++] = pos;
+            }
+
+            return count;
+        }
+
+        // candidate roots of poly, -1 if the closed form does not apply
+        static inline int solve(const GFT poly[], unsigned poly_size, GFT x[4]) {
+            switch (poly_size) {
+            case 2:
+                x[0] = RS::GF::div(poly[1], poly[0]);
+                return 1;
+
+            case 3:
+                return solve_quadratic(poly[0], poly[1], poly[2], x);
+
+            case 4: {
+                // (x + a)(x^3 + a x^2 + b x + c) = x^4 + (a^2 + b) x^2 + (ab + c) x + ac
+                GFT a = RS::GF::div(poly[1], poly[0]);
+                GFT b = RS::GF::div(poly[2], poly[0]);
+                GFT c = RS::GF::div(poly[3], poly[0]);
+
+                return solve_affine(
+                        RS::GF::add(RS::GF::mul(a, a), b),
+                        RS::GF::add(RS::GF::mul(a, b), c),
+                        RS::GF::mul(a, c), x);
+            }
+
+            case 5: {
+                GFT a = RS::GF::div(poly[1], poly[0]);
+                GFT b = RS::GF::div(poly[2], poly[0]);
+                GFT c = RS::GF::div(poly[3], poly[0]);
+                GFT d = RS::GF::div(poly[4], poly[0]);
+
+                if (a == 0)
+                    return solve_affine(b, c, d, x);
+
+                // x = y + e removes the linear term, y = 1/z turns the rest into an affine polynomial
+                GFT e = square_root(RS::GF::div(c, a));
+                GFT monic[5] = {1, a, b, c, d};
+                GFT d1 = RS::GF::poly_eval(monic, 5, e);
+                if (d1 == 0)
+                    return -1;
+
+                GFT b1 = RS::GF::add(RS::GF::mul(a, e), b);
+                GFT d1_inv = RS::GF::inv(d1);
+
+                int n = solve_affine(RS::GF::mul(b1, d1_inv), RS::GF::mul(a, d1_inv), d1_inv, x);
+                for (int i = 0; i < n; ++i)
+                    x[i] = (x[i] == 0) ? 0 : RS::GF::add(RS::GF::inv(x[i]), e);
+
+                return n;
+            }
+            }
+
+            return -1;
+        }
+
+        static inline int solve_quadratic(GFT a, GFT b, GFT c, GFT x[2]) {
+            // a x^2 + b x + c, x = (b/a) y: y^2 + y = ac/b^2
+            if (b == 0)
+                return 0; // repeated root
+
+            GFT k = RS::GF::div(RS::GF::mul(a, c), RS::GF::mul(b, b));
+            GFT y = sdata.quad[k];
+            if (y == 0 && k != 0)
+                return 0;
+
+            GFT s = RS::GF::div(b, a);
+            x[0] = RS::GF::mul(s, y);
+            x[1] = RS::GF::mul(s, RS::GF::add(y, 1));
+            return 2;
+        }
+
+        // solutions of x^4 + p x^2 + q x = r: the left side is GF(2)-linear in x, so this is
+        // a linear system over the m bits of x
+        static inline int solve_affine(GFT p, GFT q, GFT r, GFT x[4]) {
+            if (q == 0)
+                return -1; // repeated roots
+
+            constexpr unsigned m = RS::GF::power;
+            GFT basis[m] = {};
+            GFT basis_comb[m] = {};
+            GFT kernel[m];
+            unsigned kernel_size = 0;
+
+            auto reduce = [&](GFT& v, GFT& comb) {
+                for (unsigned bit = m; bit-- > 0;) {
+                    if ((v >> bit) & 1 && basis[bit] != 0) {
+                        v ^= basis[bit];
+                        comb ^= basis_comb[bit];
+                    }
+                }
+            };
+
+            for (unsigned k = 0; k < m; ++k) {
+                GFT t = GFT(1) << k;
+                GFT t2 = RS::GF::mul(t, t);
+                GFT v = RS::GF::add(RS::GF::add(RS::GF::mul(t2, t2), RS::GF::mul(p, t2)), RS::GF::mul(q, t));
+                GFT comb = t;
+
+                reduce(v, comb);
+
+                if (v == 0) {
+                    kernel[kernel_size++] = comb;
+                } else {
+                    unsigned bit = detail::ilog2_floor(v);
+                    basis[bit] = v;
+                    basis_comb[bit] = comb;
+                }
+            }
+
+            GFT comb = 0;
+            reduce(r, comb);
+            if (r != 0 || kernel_size > 2)
+                return 0;
+
+            unsigned n = 0;
+            for (unsigned i = 0; i < (1u << kernel_size); ++i) {
+                GFT s = comb;
+                for (unsigned j = 0; j < kernel_size; ++j)
+                    if ((i >> j) & 1)
+                        s ^= kernel[j];
+                x[n++] = s;
+            }
+
+            return n;
+        }
+
+        static inline GFT square_root(GFT a) {
+            if (a == 0)
+                return 0;
+
+            // the multiplicative order is odd, so halving the log is always possible
+            unsigned l = RS::GF::log(a) % order;
+            return RS::GF::exp((l & 1) ? (l + order) / 2 : l / 2);
+        }
+    };
+};
+
+template<unsigned Ecc>
+struct rs_decode_result {
+    enum status_t : uint8_t {
+        ok = 0,
+        too_many_errors,    // locator degree exceeds the correction capacity
+        roots_mismatch,     // locator does not split into distinct roots inside the codeword
+        bad_erasure,        // erasure index outside the codeword or too many erasures
+        forney_failed,      // zero Forney denominator
+        status_count
+    };
+
+    status_t status = ok;
+    unsigned corrected = 0;         // symbols that were changed
+    unsigned erasures = 0;          // erasures taken into account
+    unsigned positions[Ecc] = {};   // codeword indices of the changed symbols
+
+    explicit inline constexpr operator bool() const { return status == ok; }
+};
+
+namespace detail {
+    template<typename T, typename E = void>
+    struct has_decode_stats : std::false_type { };
+    template<typename T>
+    struct has_decode_stats<T, std::void_t<decltype(T::decode_stats)>> : std::true_type { };
+
+    template<typename GF, unsigned Ecc>
+    struct rs_decode_stats_data {
+        struct stats_t {
+            using result = rs_decode_result<Ecc>;
+
+            std::atomic<uint64_t> blocks{0};
+            std::atomic<uint64_t> clean{0};
+            std::atomic<uint64_t> symbols{0};
+            std::atomic<uint64_t> erasures{0};
+            std::atomic<uint64_t> corrected[Ecc + 1] = {};      // blocks by number of changed symbols
+            std::atomic<uint64_t> failed[result::status_count] = {};
+
+            inline void record(result const& r, bool clean_block) {
+                blocks.fetch_add(1, std::memory_order_relaxed);
+
+                if (!r) {
+                    failed[r.status].fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                if (clean_block)
+                    clean.fetch_add(1, std::memory_order_relaxed);
+
+                symbols.fetch_add(r.corrected, std::memory_order_relaxed);
+                erasures.fetch_add(r.erasures, std::memory_order_relaxed);
+                corrected[r.corrected].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            inline void reset() {
+                for (auto c : {&blocks, &clean, &symbols, &erasures})
+                    c->store(0, std::memory_order_relaxed);
+                for (auto& c : corrected)
+                    c.store(0, std::memory_order_relaxed);
+                for (auto& c : failed)
+                    c.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        static inline stats_t data{};
+    };
+}
+
+// Aggregate decode counters, shared by every codec over the same field and ecc
+template<typename RS>
+struct rs_decode_stats {
+    static constexpr auto& decode_stats = detail::rs_decode_stats_data<typename RS::GF, RS::ecc>::data;
+};
+
+struct rs_decode_stage {
+    enum stage_t : uint8_t {
+        synds = 0,
+        berlekamp_massey,   // error locator, with the erasure locator and Forney syndromes for errata
+        roots,
+        forney,             // error magnitudes, or the erasure plan lookup
+        correct,            // write-back of the magnitudes
+        total,              // whole block, the sum of the stages it went through
+        stage_count
+    };
+
+    static constexpr const char *name[stage_count] = {
+        "synds", "berlekamp_massey", "roots", "forney", "correct", "total"};
+};
+
+namespace detail {
+    template<typename T, typename E = void>
+    struct has_decode_trace : std::false_type { };
+    template<typename T>
+    struct has_decode_trace<T, std::void_t<decltype(T::decode_trace())>> : std::true_type { };
+
+    template<typename GF, unsigned Ecc>
+    struct rs_decode_trace_data {
+        using stage_t = rs_decode_stage::stage_t;
+        static constexpr unsigned stages = rs_decode_stage::stage_count;
+
+        // bucket b holds latencies of b significant bits, [2^(b-1), 2^b) ns, the last one is open
+        static constexpr unsigned buckets = 40;
+
+        static inline unsigned bucket(uint64_t ns) {
+            return ns ? std::min(unsigned(64 - __builtin_clzll(ns)), buckets - 1) : 0;
+        }
+
+        struct snapshot_t {
+            uint64_t histogram[stages][buckets] = {};
+            uint64_t errors[Ecc + 1] = {};      // blocks by locator degree, erasures included
+
+            inline uint64_t count(stage_t s) const {
+                uint64_t n = 0;
+                for (auto c : histogram[s])
+                    n += c;
+                return n;
+            }
+
+            // Upper bound of the bucket holding quantile q, so within a factor of two of it
+            inline uint64_t percentile(stage_t s, double q) const {
+                auto n = count(s);
+                if (n == 0)
+                    return 0;
+
+                uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * double(n))));
+                uint64_t seen = 0;
+                for (unsigned b = 0; b < buckets; ++b) {
+                    seen += histogram[s][b];
+                    if (seen >= rank)
+                        return (uint64_t(1) << b) - 1;
+                }
+
+                return ~uint64_t(0);
+            }
+        };
+
+        // Counters of one thread. Only their own thread writes them, with a relaxed load and
+        // store instead of a locked read-modify-write; snapshot() may read them from any thread.
+        struct local_t {
+            std::atomic<uint64_t> histogram[stages][buckets] = {};
+            std::atomic<uint64_t> errors[Ecc + 1] = {};
+
+            inline local_t() {
+                std::lock_guard<std::mutex> guard(lock);
+                live.push_back(this);
+            }
+
+            inline ~local_t() {
+                std::lock_guard<std::mutex> guard(lock);
+                add_to(retired);
+                live.erase(std::find(live.begin(), live.end(), this));
+            }
+
+            static inline void bump(std::atomic<uint64_t>& c) {
+                c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            inline void record(stage_t s, uint64_t ns) { bump(histogram[s][bucket(ns)]); }
+
+            inline void block(unsigned errors_found, uint64_t ns) {
+                bump(histogram[rs_decode_stage::total][bucket(ns)]);
+                bump(errors[std::min(errors_found, Ecc)]);
+            }
+
+            inline void add_to(snapshot_t& s) const {
+                for (unsigned i = 0; i < stages; ++i)
+                    for (unsigned b = 0; b < buckets; ++b)
+                        s.histogram[i][b] += histogram[i][b].load(std::memory_order_relaxed);
+                for (unsigned i = 0; i < Ecc + 1; ++i)
+                    s.errors[i] += errors[i].load(std::memory_order_relaxed);
+            }
+
+            inline void clear() {
+                for (auto& h : histogram)
+                    for (auto& c : h)
+                        c.store(0, std::memory_order_relaxed);
+                for (auto& c : errors)
+                    c.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        static inline std::mutex lock;
+        static inline std::vector<local_t *> live;
+        static inline snapshot_t retired{};     // threads that have exited
+
+        static inline thread_local local_t data{};
+
+        static inline snapshot_t snapshot() {
+            std::lock_guard<std::mutex> guard(lock);
+            snapshot_t s = retired;
+            for (auto l : live)
+                l->add_to(s);
+            return s;
+        }
+
+        // Exact only while no thread is decoding, a concurrent increment may survive it
+        static inline void reset() {
+            std::lock_guard<std::mutex> guard(lock);
+            retired = snapshot_t{};
+            for (auto l : live)
+                l->clear();
+        }
+    };
+
+    // Timestamps one block between decode stages; empty and free unless RS has a trace policy
+    template<typename RS, bool = has_decode_trace<RS>::value>
+    struct rs_decode_tracer {
+        inline void start() { }
+        inline void stage(rs_decode_stage::stage_t) { }
+        inline void stage_shared(rs_decode_stage::stage_t, unsigned) { }
+        inline void errors(unsigned) { }
+        inline void done() { }
+    };
+
+    template<typename RS>
+    struct rs_decode_tracer<RS, true> {
+        using clock = std::chrono::steady_clock;
+
+        clock::time_point last;
+        uint64_t spent = 0;
+        unsigned found = 0;
+
+        inline void start() { last = clock::now(); }
+
+        inline void stage(rs_decode_stage::stage_t s) { stage_shared(s, 1); }
+
+        // The stage ran for `blocks` blocks at once, this one is charged its share
+        inline void stage_shared(rs_decode_stage::stage_t s, unsigned blocks) {
+            auto now = clock::now();
+            auto ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()) / blocks;
+            RS::decode_trace().record(s, ns);
+            spent += ns;
+            last = now;
+        }
+
+        inline void errors(unsigned n) { found = n; }
+        inline void done() { RS::decode_trace().block(found, spent); }
+    };
+}
+
+// Per-stage decode latency histograms and locator degrees, kept per thread so that tracing
+// adds no shared writes to the decoder; decode_trace_snapshot() sums every thread on demand
+template<typename RS>
+struct rs_decode_trace {
+    using trace_data = detail::rs_decode_trace_data<typename RS::GF, RS::ecc>;
+
+    static inline auto& decode_trace() { return trace_data::data; }
+    static inline auto decode_trace_snapshot() { return trace_data::snapshot(); }
+    static inline void decode_trace_reset() { trace_data::reset(); }
+};
+
+namespace detail {
+    template<typename T, typename E = void>
+    struct has_erasure_plans : std::false_type { };
+    template<typename T>
+    struct has_erasure_plans<T, std::void_t<decltype(T::erasure_plans())>> : std::true_type { };
+
+    // Erasure-only decoding is linear in the syndromes: with erasures at X_i,
+    // S_k = sum e_i X_i^k for k < count, so the magnitudes are one matrix-vector product
+    // away once the inverse of that Vandermonde system is known for the pattern.
+    template<typename GF, unsigned Ecc, unsigned Capacity>
+    struct rs_erasure_plan_data {
+        using GFT = typename GF::Repr;
+
+        struct plan_t {
+            unsigned count = 0;
+            uint64_t used = 0;
+            bool valid = false;
+            GFT pos[Ecc] = {};              // ascending, the key of the erasure set
+            GFT recovery[Ecc][Ecc] = {};    // magnitude at pos[i] = recovery[i] * (S_0 .. S_count-1)
+
+            // err_mag[i] is the magnitude of the caller's i-th position, held in row rows[i]
+            inline void apply(const GFT synds_rev[Ecc], const unsigned rows[], GFT err_mag[]) const {
+                for (unsigned i = 0; i < count; ++i) {
+                    GFT t = 0;
+                    for (unsigned k = 0; k < count; ++k)
+                        t = GF::add(t, GF::mul(recovery[rows[i]][k], synds_rev[Ecc - 1 - k]));
+                    err_mag[i] = t;
+                }
+            }
+        };
+
+        // Fixed-capacity LRU, one per thread
+        struct cache_t {
+            plan_t plans[Capacity];
+            uint64_t clock = 0;
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+
+            // Plans are keyed on the set of positions, in any order; rows[i] receives the plan row
+            // of err_pos[i]. Returns nullptr if the pattern is singular (repeated positions)
+            inline const plan_t *find(const GFT err_pos[], unsigned count, unsigned rows[]) {
+                // insertion sort of the indices, count is at most Ecc
+                unsigned order[Ecc];
+                for (unsigned i = 0; i < count; ++i) {
+                    unsigned j = i;
+                    for (; j > 0 && err_pos[order[j - 1]] > err_pos[i]; --j)
+                        order[j] = order[j - 1];
+                    order[j] = i;
+                }
+
+                GFT key[Ecc];
+                for (unsigned r = 0; r < count; ++r) {
+                    key[r] = err_pos[order[r]];
+                    rows[order[r]] = r;
+                }
+
+                plan_t *victim = &plans[0];
+
+                for (auto& p : plans) {
+                    if (p.used && p.count == count && std::equal(key, key + count, p.pos)) {
+                        p.used = ++clock;
+                        hits += 1;
+                        return p.valid ? &p : nullptr;
+                    }
+
+                    if (p.used < victim->used)
+                        victim = &p;
+                }
+
+                misses += 1;
+                build(*victim, key, count);
+                victim->used = ++clock;
+                return victim->valid ? victim : nullptr;
+            }
+
+            inline void reset() {
+                *this = cache_t{};
+            }
+
+        private:
+            static inline void build(plan_t& p, const GFT err_pos[], unsigned count) {
+                constexpr unsigned order = GF::charact - 1;
+
+                p.count = count;
+                std::copy_n(err_pos, count, p.pos);
+
+                // Gauss-Jordan on [V | I] with V[k][i] = X_i^k
+                GFT a[Ecc][Ecc];
+                for (unsigned k = 0; k < count; ++k) {
+                    for (unsigned i = 0; i < count; ++i) {
+                        a[k][i] = GF::exp((k * unsigned(err_pos[i])) % order);
+                        p.recovery[k][i] = GFT(k == i);
+                    }
+                }
+
+                p.valid = false;
+                for (unsigned c = 0; c < count; ++c) {
+                    unsigned r = c;
+                    while (r < count && a[r][c] == 0)
+                        ++r;
+                    if (r == count)
+                        return;
+
+                    if (r != c) {
+                        std::swap_ranges(&a[r][0], &a[r][count], &a[c][0]);
+                        std::swap_ranges(&p.recovery[r][0], &p.recovery[r][count], &p.recovery[c][0]);
+                    }
+
+                    GFT norm = GF::inv(a[c][c]);
+                    for (unsigned j = 0; j < count; ++j) {
+                        a[c][j] = GF::mul(a[c][j], norm);
+                        p.recovery[c][j] = GF::mul(p.recovery[c][j], norm);
+                    }
+
+                    for (unsigned k = 0; k < count; ++k) {
+                        GFT f = a[k][c];
+                        if (k == c || f == 0)
+                            continue;
+
+                        for (unsigned j = 0; j < count; ++j) {
+                            a[k][j] = GF::sub(a[k][j], GF::mul(f, a[c][j]));
+                            p.recovery[k][j] = GF::sub(p.recovery[k][j], GF::mul(f, p.recovery[c][j]));
+                        }
+                    }
+                }
+
+                // the magnitudes are added to the received word, so they are the negated error values
+                if constexpr (GF::prime != 2) {
+                    for (unsigned i = 0; i < count; ++i)
+                        for (unsigned k = 0; k < count; ++k)
+                            p.recovery[i][k] = GF::sub(0, p.recovery[i][k]);
+                }
+
+                p.valid = true;
+            }
+        };
+
+        static inline thread_local cache_t data{};
+    };
+}
+
+// Per-thread LRU of erasure-only decode plans, keyed by erasure pattern
+template<unsigned Capacity>
+struct rs_erasure_plans_t {
+    static_assert(Capacity > 0);
+
+    template<typename RS>
+    struct type {
+        static inline auto& erasure_plans() {
+            return detail::rs_erasure_plan_data<typename RS::GF, RS::ecc, Capacity>::data;
+        }
+    };
+};
+
+template<typename RS>
+using rs_erasure_plans = typename rs_erasure_plans_t<8>::template type<RS>;
+
 template<typename RS>
 struct rs_decode {
     using GFT = typename RS::GF::Repr;
+    using result = rs_decode_result<RS::ecc>;
+    using stage = rs_decode_stage;
+    using tracer = detail::rs_decode_tracer<RS>;
 
     template<typename T, typename U>
-    static inline bool decode(T data, unsigned size, U rem) {
+    static inline result decode(T data, unsigned size, U rem) {
+        result r;
+        tracer trace;
+        trace.start();
+
         typename RS::synds_array_t synds;
         RS::synds(synds, &data[0], size, rem);
+        trace.stage(stage::synds);
 
         if (std::all_of(&synds[0], &synds[RS::ecc], std::logical_not()))
-            return true;
+            return report(r, result::ok, trace, true);
 
         GFT err_poly[RS::ecc];
         auto errors = berlekamp_massey(synds, err_poly);
+        trace.stage(stage::berlekamp_massey);
+        trace.errors(errors);
+
+        if (2 * errors > RS::ecc)
+            return report(r, result::too_many_errors, trace);
 
         GFT err_pos[RS::ecc / 2];
         auto roots = RS::roots(&err_poly[RS::ecc-errors-1], errors+1, err_pos, size + RS::ecc);
+        trace.stage(stage::roots);
 
         if (errors != roots)
-            return false;
+            return report(r, result::roots_mismatch, trace);
 
-        GFT err_mag[RS::ecc / 2];
-        forney(synds, &err_poly[RS::ecc-errors-1], err_pos, errors, err_mag);
+        GFT err_mag[RS::ecc];
+        bool found = forney(synds, &err_poly[RS::ecc-errors-1], err_pos, errors, err_mag);
+        trace.stage(stage::forney);
 
-        for (unsigned i = 0; i < errors; ++i) {
-            unsigned pos = size + RS::ecc - 1 - err_pos[i];
-            if (pos >= size + RS::ecc)
-                return false;
+        if (!found)
+            return report(r, result::forney_failed, trace);
 
-            if (pos < size)
-                data[pos] = RS::GF::add(data[pos], err_mag[i]);
-            else
-                rem[pos - size] = RS::GF::add(rem[pos - size], err_mag[i]);
-        }
+        auto status = correct(data, size, rem, err_pos, err_mag, errors, r);
+        trace.stage(stage::correct);
 
-        return true;
+        return report(r, status, trace);
     }
 
     template<typename T, typename U, typename V>
-    static inline bool decode(T data, unsigned size, U rem, const V err_idx, unsigned errors) {
+    static inline result decode(T data, unsigned size, U rem, const V err_idx, unsigned errors) {
+        result r;
+        tracer trace;
+        trace.start();
+
         if (errors > RS::ecc)
-            return false;
+            return report(r, result::bad_erasure, trace);
 
         typename RS::synds_array_t synds;
         RS::synds(synds, &data[0], size, rem);
+        trace.stage(stage::synds);
 
         if (std::all_of(&synds[0], &synds[RS::ecc], std::logical_not()))
-            return true;
+            return report(r, result::ok, trace, true);
 
-        GFT err_pos[RS::ecc];
+        trace.errors(errors);
+
+        GFT err_pos[RS::ecc] = {};
         for (unsigned i = 0; i < errors; ++i) {
             if (err_idx[i] > size + RS::ecc - 1)
-                return false;
+                return report(r, result::bad_erasure, trace);
 
             err_pos[i] = size + RS::ecc - 1 - err_idx[i];
         }
 
-        GFT err_poly[RS::ecc + 1] = {1};
-        unsigned err_poly_len = 1;
+        GFT err_mag[RS::ecc];
 
-        {
-            GFT temp[RS::ecc + 1] = {1};
+        if constexpr (detail::has_erasure_plans<RS>::value) {
+            unsigned rows[RS::ecc];
+            auto plan = RS::erasure_plans().find(err_pos, errors, rows);
+            if (plan)
+                plan->apply(synds, rows, err_mag);
+            trace.stage(stage::forney);
+
+            if (!plan)
+                return report(r, result::forney_failed, trace);
+        } else {
+            GFT err_poly[RS::ecc + 1];
+            erasure_locator(err_pos, errors, err_poly);
+
+            bool found = forney(synds, err_poly, err_pos, errors, err_mag);
+            trace.stage(stage::forney);
+
+            if (!found)
+                return report(r, result::forney_failed, trace);
+        }
+
+        r.erasures = errors;
+        auto status = correct(data, size, rem, err_pos, err_mag, errors, r);
+        trace.stage(stage::correct);
+
+        return report(r, status, trace);
+    }
+
+    template<typename T, typename U, typename V>
+    static inline result decode_errata(T data, unsigned size, U rem, const V eras_idx, unsigned erasures) {
+        result r;
+        tracer trace;
+        trace.start();
+
+        if (erasures > RS::ecc)
+            return report(r, result::bad_erasure, trace);
+
+        typename RS::synds_array_t synds;
+        RS::synds(synds, &data[0], size, rem);
+        trace.stage(stage::synds);
+
+        if (std::all_of(&synds[0], &synds[RS::ecc], std::logical_not()))
+            return report(r, result::ok, trace, true);
+
+        GFT err_pos[RS::ecc];
+        for (unsigned i = 0; i < erasures; ++i) {
+            if (eras_idx[i] > size + RS::ecc - 1)
+                return report(r, result::bad_erasure, trace);
+
+            err_pos[i] = size + RS::ecc - 1 - eras_idx[i];
+        }
+
+        GFT eras_poly[RS::ecc + 1];
+        erasure_locator(err_pos, erasures, eras_poly);
+
+        // Forney syndromes: T(x) = S(x) * eras_poly(x) mod x^ecc, the first `erasures`
+        // terms carry no information about the unknown errors and are dropped
+        GFT fsynds[RS::ecc] = {};
+        for (unsigned k = erasures; k < RS::ecc; ++k) {
+            GFT t = 0;
+            for (unsigned j = 0; j <= std::min(k, erasures); ++j)
+                t = RS::GF::add(t, RS::GF::mul(eras_poly[erasures - j], synds[RS::ecc - 1 - (k - j)]));
+            fsynds[RS::ecc - 1 - (k - erasures)] = t;
+        }
+
+        GFT err_poly[RS::ecc];
+        auto errors = berlekamp_massey(fsynds, err_poly, RS::ecc - erasures);
+        trace.stage(stage::berlekamp_massey);
+        trace.errors(errors + erasures);
 
-            auto p1 = (errors & 1) ? &err_poly[0] : &temp[0];
-            auto p2 = (errors & 1) ? &temp[0] : &err_poly[0];
+        if (2 * errors > RS::ecc - erasures)
+            return report(r, result::too_many_errors, trace);
 
-            for (unsigned i = 0; i < errors; ++i) {
-                GFT factor[2] = {RS::GF::sub(0, RS::GF::exp(err_pos[i])), 1};
-                err_poly_len = RS::GF::poly_mul(p1, p2, err_poly_len, factor, 2);
-                std::swap(p1, p2);
+        if (errors > 0) {
+            auto roots = RS::roots(&err_poly[RS::ecc-errors-1], errors+1, &err_pos[erasures], size + RS::ecc);
+            trace.stage(stage::roots);
+
+            if (errors != roots)
+                return report(r, result::roots_mismatch, trace);
+
+            for (unsigned i = erasures; i < erasures + errors; ++i) {
+                if (std::find(&err_pos[0], &err_pos[erasures], err_pos[i]) != &err_pos[erasures])
+                    return report(r, result::roots_mismatch, trace);
             }
         }
 
-        assert(err_poly_len == errors + 1);
+        // errata locator
+        GFT errata_poly[RS::ecc + 1];
+        RS::GF::poly_mul(errata_poly,
+                &err_poly[RS::ecc-errors-1], errors + 1,
+                eras_poly, erasures + 1);
 
         GFT err_mag[RS::ecc];
-        forney(synds, err_poly, err_pos, errors, err_mag);
+        bool found = forney(synds, errata_poly, err_pos, errors + erasures, err_mag);
+        trace.stage(stage::forney);
 
-        for (unsigned i = 0; i < errors; ++i) {
-            unsigned pos = err_idx[i];
-            if (pos >= size + RS::ecc)
-                return false;
+        if (!found)
+            return report(r, result::forney_failed, trace);
+
+        r.erasures = erasures;
+        auto status = correct(data, size, rem, err_pos, err_mag, errors + erasures, r);
+        trace.stage(stage::correct);
+
+        return report(r, status, trace);
+    }
+
+    static constexpr unsigned batch_chunk = 64;
+
+    static constexpr bool bitslice_synds = RS::GF::prime == 2 && RS::GF::power == 8;
+    // the planes cost the same for any number of blocks, below this the scalar loop is faster
+    static constexpr unsigned bitslice_min = 20;
+
+    // Syndromes of count <= batch_chunk blocks of stride symbols, one block per bit lane as in
+    // bch_batch_t: a transpose turns 8 byte positions of the chunk into 64 bit planes, and each
+    // Horner step multiplies the planes of S_i by the constant alpha^i as an 8x8 bit matrix
+    template<typename S, typename T>
+    static inline void synds_bitslice(S synds[], T data, unsigned count, unsigned stride) {
+        static_assert(batch_chunk == 64);
+        static constexpr auto& gen_roots = rs_generator<RS>::sdata.roots;
+
+        // column p of the multiplication by alpha^i
+        uint8_t cols[RS::ecc][8];
+        for (unsigned i = 0; i < RS::ecc; ++i)
+            for (unsigned p = 0; p < 8; ++p)
+                cols[i][p] = RS::GF::mul(gen_roots[i], uint8_t(1 << p));
+
+        // bit q of S_i for every block; leading zero positions pad stride to whole columns
+        uint64_t s[RS::ecc][8] = {};
+        const unsigned padded = (stride + 7) / 8 * 8;
+        const unsigned lead = padded - stride;
+
+        for (unsigned v = 0; v < padded; v += 8) {
+            uint64_t rows[64] = {};
+            for (unsigned w = 0; w < count; ++w) {
+                auto b = &data[w * stride];
+                if (v >= lead) {
+                    rows[w] = detail::load_be64(&b[v - lead]);
+                } else {
+                    for (unsigned k = lead; k < 8; ++k)
+                        rows[w] |= uint64_t(b[k - lead]) << (56 - 8 * k);
+                }
+            }
+
+            // rows[8k + 7 - p] now holds bit p of position v + k of every block
+            detail::transpose64(rows);
+
+            for (unsigned k = 0; k < 8; ++k) {
+                for (unsigned i = 0; i < RS::ecc; ++i) {
+                    uint64_t next[8];
+                    for (unsigned q = 0; q < 8; ++q)
+                        next[q] = rows[8 * k + 7 - q];
+
+                    for (unsigned p = 0; p < 8; ++p)
+                        for (unsigned m = cols[i][p]; m; m &= m - 1)
+                            next[__builtin_ctz(m)] ^= s[i][p];
+
+                    std::copy_n(next, 8, s[i]);
+                }
+            }
+        }
+
+        // back to bytes, 8 syndromes per transpose; row w is block w, S_i in byte i - g MSB first
+        for (unsigned w = 0; w < count; ++w)
+            std::fill(std::begin(synds[w]), std::end(synds[w]), 0);
+
+        for (unsigned g = 0; g < RS::ecc; g += 8) {
+            uint64_t rows[64] = {};
+            for (unsigned i = g; i < std::min(g + 8, RS::ecc); ++i)
+                for (unsigned q = 0; q < 8; ++q)
+                    rows[8 * (i - g) + 7 - q] = s[i][q];
+
+            detail::transpose64(rows);
+
+            for (unsigned w = 0; w < count; ++w)
+                for (unsigned i = g; i < std::min(g + 8, RS::ecc); ++i)
+                    synds[w][RS::ecc - 1 - i] = uint8_t(rows[w] >> (56 - 8 * (i - g)));
+        }
+    }
+
+    // Decodes `blocks` codewords of size + ecc symbols stored back to back. Syndromes are
+    // computed for a whole chunk first, bitsliced across its blocks over GF(2^8), then only
+    // the dirty blocks run through each of the remaining stages in turn. Returns the number of blocks that could not be decoded.
+    template<typename T>
+    static inline unsigned decode_batch(T data, unsigned blocks, unsigned size, result results[] = nullptr) {
+        const unsigned stride = size + RS::ecc;
+        unsigned failed = 0;
+
+        for (unsigned first = 0; first < blocks; first += batch_chunk) {
+            const unsigned count = std::min(batch_chunk, blocks - first);
+            auto block = [&](unsigned i) { return &data[(first + i) * stride]; };
+
+            typename RS::synds_array_t synds[batch_chunk];
+            unsigned dirty[batch_chunk];
+            unsigned dirty_count = 0;
+            tracer trace[batch_chunk];
+
+            bool sliced = false;
+            if constexpr (bitslice_synds) {
+                if (count >= bitslice_min) {
+                    for (unsigned i = 0; i < count; ++i)
+                        trace[i].start();
+
+                    synds_bitslice(synds, block(0), count, stride);
+                    sliced = true;
+
+                    for (unsigned i = 0; i < count; ++i)
+                        trace[i].stage_shared(stage::synds, count);
+                }
+            }
+
+            if (!sliced) {
+                for (unsigned i = 0; i < count; ++i) {
+                    trace[i].start();
+                    RS::synds(synds[i], block(i), size, block(i) + size);
+                    trace[i].stage(stage::synds);
+                }
+            }
+
+            for (unsigned i = 0; i < count; ++i) {
+                if (std::all_of(&synds[i][0], &synds[i][RS::ecc], std::logical_not())) {
+                    result r;
+                    report(r, result::ok, trace[i], true);
+                    if (results)
+                        results[first + i] = r;
+                } else {
+                    dirty[dirty_count++] = i;
+                }
+            }
+
+            if (dirty_count == 0)
+                continue;
+
+            typename result::status_t status[batch_chunk];
+            GFT err_poly[batch_chunk][RS::ecc];
+            unsigned errors[batch_chunk];
+
+            for (unsigned k = 0; k < dirty_count; ++k) {
+                auto& t = trace[dirty[k]];
+                t.start();
+                errors[k] = berlekamp_massey(synds[dirty[k]], err_poly[k]);
+                status[k] = (2 * errors[k] > RS::ecc) ? result::too_many_errors : result::ok;
+                t.stage(stage::berlekamp_massey);
+                t.errors(errors[k]);
+            }
+
+            GFT err_pos[batch_chunk][RS::ecc / 2];
+
+            for (unsigned k = 0; k < dirty_count; ++k) {
+                if (status[k] != result::ok)
+                    continue;
+
+                auto& t = trace[dirty[k]];
+                t.start();
+                auto roots = RS::roots(&err_poly[k][RS::ecc-errors[k]-1], errors[k]+1, err_pos[k], stride);
+                if (roots != errors[k])
+                    status[k] = result::roots_mismatch;
+                t.stage(stage::roots);
+            }
+
+            for (unsigned k = 0; k < dirty_count; ++k) {
+                result r;
+                auto i = dirty[k];
+
+                if (status[k] == result::ok) {
+                    GFT err_mag[RS::ecc];
+
+                    trace[i].start();
+                    bool found = forney(synds[i], &err_poly[k][RS::ecc-errors[k]-1], err_pos[k], errors[k], err_mag);
+                    trace[i].stage(stage::forney);
+
+                    if (!found) {
+                        status[k] = result::forney_failed;
+                    } else {
+                        status[k] = correct(block(i), size, block(i) + size, err_pos[k], err_mag, errors[k], r);
+                        trace[i].stage(stage::correct);
+                    }
+                }
+
+                report(r, status[k], trace[i]);
+                failed += !r;
+
+                if (results)
+                    results[first + i] = r;
+            }
+        }
+
+        return failed;
+    }
+
+    static inline result report(result& r, typename result::status_t status, tracer& trace, bool clean = false) {
+        r.status = status;
+
+        if constexpr (detail::has_decode_stats<RS>::value)
+            RS::decode_stats.record(r, clean);
+
+        trace.done();
+
+        return r;
+    }
+
+    template<typename T, typename U>
+    static inline typename result::status_t correct(T data, unsigned size, U rem,
+            const GFT err_pos[], const GFT err_mag[], unsigned count, result& r)
+    {
+        for (unsigned i = 0; i < count; ++i) {
+            if (err_pos[i] >= size + RS::ecc)
+                return result::roots_mismatch;
+        }
+
+        for (unsigned i = 0; i < count; ++i) {
+            if (err_mag[i] == 0)
+                continue;
+
+            unsigned pos = size + RS::ecc - 1 - err_pos[i];
 
             if (pos < size)
                 data[pos] = RS::GF::add(data[pos], err_mag[i]);
             else
                 rem[pos - size] = RS::GF::add(rem[pos - size], err_mag[i]);
+
+            r.positions[r.corrected++] = pos;
         }
 
-        return true;
+        return result::ok;
     }
 
-    static inline unsigned berlekamp_massey(const GFT synds_rev[RS::ecc], GFT err_poly[RS::ecc]) {
-        GFT prev[RS::ecc] = {};
-        GFT temp[RS::ecc];
-        GFT synds[RS::ecc];
-        std::reverse_copy(synds_rev, &synds_rev[RS::ecc], synds);
-        std::fill_n(err_poly, RS::ecc, 0);
+    static inline void erasure_locator(const GFT err_pos[], unsigned errors, GFT err_poly[RS::ecc + 1]) {
+        GFT temp[RS::ecc + 1] = {1};
+        unsigned err_poly_len = 1;
+
+        auto p1 = (errors & 1) ? &err_poly[0] : &temp[0];
+        auto p2 = (errors & 1) ? &temp[0] : &err_poly[0];
+        p2[0] = 1;
+
+        for (unsigned i = 0; i < errors; ++i) {
+            GFT factor[2] = {RS::GF::sub(0, RS::GF::exp(err_pos[i])), 1};
+            err_poly_len = RS::GF::poly_mul(p1, p2, err_poly_len, factor, 2);
+            std::swap(p1, p2);
+        }
+
+        assert(err_poly_len == errors + 1);
+    }
 
-        prev[RS::ecc-1] = 1;
-        err_poly[RS::ecc-1] = 1;
+    // Inversion-free Berlekamp-Massey: lambda = gamma * lambda - d * x^m * prev.
+    // Only the live coefficients are touched and the locator is made monic once at the end.
+    static inline unsigned berlekamp_massey(const GFT synds_rev[RS::ecc], GFT err_poly[RS::ecc], unsigned count = RS::ecc) {
+        // lowest degree first
+        GFT buf_a[RS::ecc + 1] = {1};
+        GFT buf_b[RS::ecc + 1] = {1};
+        GFT *lambda = buf_a;
+        GFT *prev = buf_b;
+        unsigned lambda_len = 1;
+        unsigned prev_len = 1;
 
         unsigned errors = 0;
         unsigned m = 1;
-        GFT b = 1;
+        GFT gamma = 1;
 
-        for (unsigned n = 0; n < RS::ecc; ++n) {
-            unsigned d = synds[n]; // discrepancy
-            for (unsigned i = 1; i < errors + 1; ++i)
-                d = RS::GF::add(d, RS::GF::mul(err_poly[RS::ecc - 1 - i], synds[n-i]));
+        for (unsigned n = 0; n < count; ++n) {
+            GFT d = RS::GF::mul(lambda[0], synds_rev[RS::ecc - 1 - n]); // discrepancy
+            for (unsigned i = 1; i < std::min({errors, n, lambda_len - 1}) + 1; ++i)
+                d = RS::GF::add(d, RS::GF::mul(lambda[i], synds_rev[RS::ecc - 1 - n + i]));
 
             if (d == 0) {  // discrepancy is already zero
                 m = m + 1;
-            } else if (2 * errors <= n) {
-                std::copy_n(err_poly, RS::ecc, temp);
+                continue;
+            }
 
-                RS::GF::poly_shift(prev, RS::ecc, m);
-                RS::GF::poly_scale(prev, RS::ecc, RS::GF::div(d, b));
+            const unsigned len = std::max(lambda_len, prev_len + m);
+            assert(len <= RS::ecc + 1);
 
-                RS::GF::poly_sub(err_poly, prev, RS::ecc);
+            std::fill(&lambda[lambda_len], &lambda[len], 0);
+            std::fill(&prev[prev_len], &prev[len - m], 0);
 
-                errors = n + 1 - errors;
-                std::copy_n(temp, RS::ecc, prev);
+            if (2 * errors <= n) {
+                // new lambda is built in place of prev, which takes over the old lambda
+                for (unsigned i = len; i-- > m;)
+                    prev[i] = RS::GF::sub(RS::GF::mul(gamma, lambda[i]), RS::GF::mul(d, prev[i - m]));
+                for (unsigned i = std::min(m, len); i-- > 0;)
+                    prev[i] = RS::GF::mul(gamma, lambda[i]);
 
-                b = d;
+                std::swap(lambda, prev);
+                prev_len = lambda_len;
+                lambda_len = len;
+
+                errors = n + 1 - errors;
+                gamma = d;
                 m = 1;
             } else {
-                std::copy_n(prev, RS::ecc, temp);
-
-                RS::GF::poly_shift(temp, RS::ecc, m);
-
-                RS::GF::poly_scale(temp, RS::ecc, RS::GF::div(d, b));
-                RS::GF::poly_sub(err_poly, temp, RS::ecc);
+                for (unsigned i = 0; i < std::min(m, len); ++i)
+                    lambda[i] = RS::GF::mul(gamma, lambda[i]);
+                for (unsigned i = m; i < len; ++i)
+                    lambda[i] = RS::GF::sub(RS::GF::mul(gamma, lambda[i]), RS::GF::mul(d, prev[i - m]));
 
+                lambda_len = len;
+                prev_len = len - m;
                 m = m + 1;
             }
         }
 
+        std::fill_n(err_poly, RS::ecc, 0);
+
+        auto norm = RS::GF::inv(lambda[0]);
+        for (unsigned i = 0; i < std::min(errors + 1, RS::ecc); ++i)
+            err_poly[RS::ecc - 1 - i] = (i < lambda_len) ? RS::GF::mul(norm, lambda[i]) : 0;
+
         return errors;
     }
 
-    static inline void forney(
-            const GFT synds_rev[RS::ecc], GFT err_poly[], const GFT err_pos[],
+    static inline bool forney(
+            const GFT synds_rev[RS::ecc], const GFT err_poly[], const GFT err_pos[],
             const unsigned err_count, GFT err_mag[])
     {
-        GFT err_eval[RS::ecc * 2];
-        auto err_eval_size = RS::GF::poly_mul(err_eval,
-                synds_rev, RS::ecc,
-                err_poly, err_count + 1);
+        constexpr unsigned order = RS::GF::charact - 1;
+
+        // err_poly is highest degree first, lambda_j = err_poly[err_count - j]
+        // omega(x) = S(x) * lambda(x) mod x^err_count, lowest degree first
+        GFT err_eval[RS::ecc];
+        for (unsigned k = 0; k < err_count; ++k) {
+            GFT t = 0;
+            for (unsigned j = 0; j <= k; ++j)
+                t = RS::GF::add(t, RS::GF::mul(err_poly[err_count - j], synds_rev[RS::ecc - 1 - (k - j)]));
+            err_eval[k] = t;
+        }
+
+        // lambda'(x), lowest degree first
+        GFT err_poly_deriv[RS::ecc];
+        for (unsigned k = 0; k < err_count; ++k) {
+            GFT c = err_poly[err_count - k - 1];
+            if constexpr (RS::GF::prime == 2)
+                err_poly_deriv[k] = (k & 1) ? 0 : c;
+            else
+                err_poly_deriv[k] = RS::GF::mul(c, (k + 1) % RS::GF::prime);
+        }
 
-        GFT x_poly[RS::ecc + 1] = {1};
-        auto err_eval_begin = RS::GF::ex_synth_div(
-                err_eval, err_eval_size,
-                x_poly, RS::ecc + 1);
-        while (err_eval[err_eval_begin] == 0) {
-            err_eval_begin++;
-            assert(err_eval_begin < err_eval_size);
+        GFT xi[RS::ecc];
+        GFT xi_inv[RS::ecc];
+        GFT n[RS::ecc] = {};
+        GFT d[RS::ecc] = {};
+
+        for (unsigned i = 0; i < err_count; ++i) {
+            xi[i] = RS::GF::exp(err_pos[i] % order);
+            xi_inv[i] = RS::GF::exp((order - err_pos[i] % order) % order);
         }
-        err_eval_size = err_eval_size - err_eval_begin;
 
-        RS::GF::poly_deriv(err_poly, err_count + 1);
-        auto err_poly_deriv = err_poly + 1;
-        auto err_poly_deriv_size = err_count;
+        for (unsigned k = err_count; k-- > 0;) {
+            for (unsigned i = 0; i < err_count; ++i) {
+                n[i] = RS::GF::add(RS::GF::mul(n[i], xi_inv[i]), err_eval[k]);
+                d[i] = RS::GF::add(RS::GF::mul(d[i], xi_inv[i]), err_poly_deriv[k]);
+            }
+        }
 
+        // batch inversion of the denominators, err_mag holds the prefix products
+        GFT acc = 1;
         for (unsigned i = 0; i < err_count; ++i) {
-            auto xi = RS::GF::exp(err_pos[i]);
-            auto xi_inv = RS::GF::inv(xi);
+            if (d[i] == 0)
+                return false;
 
-            auto n = RS::GF::poly_eval(&err_eval[err_eval_begin], err_eval_size, xi_inv);
-            auto d = RS::GF::poly_eval(err_poly_deriv, err_poly_deriv_size, xi_inv);
+            err_mag[i] = acc;
+            acc = RS::GF::mul(acc, d[i]);
+        }
+
+        if (err_count > 0)
+            acc = RS::GF::inv(acc);
+
+        for (unsigned i = err_count; i-- > 0;) {
+            GFT d_inv = RS::GF::mul(acc, err_mag[i]);
+            acc = RS::GF::mul(acc, d[i]);
 
-            err_mag[i] = RS::GF::mul(xi, RS::GF::div(n, d));
+            err_mag[i] = RS::GF::mul(RS::GF::mul(xi[i], n[i]), d_inv);
         }
+
+        return true;
     }
 };
 
@@ -556,6 +1706,9 @@ struct rs_impl_base : rs_base<GF, Ecc>, Fs<rs_base<GF, Ecc>>... { };
 template<typename Impl, template<class>typename...Fs>
 struct rs_impl : rs_base<typename Impl::GF, Impl::ecc>, Fs<Impl>... {
     static inline auto static_data_size = detail::get_sdata_size<rs_generator<Impl>, Fs<Impl>...>();
+
+    // Static tables of the field and of every policy, shared ones included
+    using sdata_policies = typename Impl::GF::sdata_policies::template append<rs_generator<Impl>, Fs<Impl>...>;
 };
 
 template<typename GF, unsigned Ecc, template<class>typename...Fs>
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "file_protect.hpp"
+#include "stream.hpp"
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+            "usage: %s encode|decode [-e ecc] [-t threads] < input > output\n"
+            "  -e ecc         parity symbols per codeword: 2, 4, 8, 16 or 32 (default: 8)\n"
+            "  -t threads     coding threads (default: all cores)\n"
+            "exit status: 0 ok, 1 uncorrectable codewords passed through, 2 usage or I/O error\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string mode = argv[1];
+    unsigned ecc = 8;
+    unsigned threads = std::thread::hardware_concurrency();
+
+    for (int i = 2; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (!std::strcmp(argv[i], "-e"))
+            ecc = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "-t"))
+            threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if ((mode != "encode" && mode != "decode") || !rs_file_ecc_supported(ecc)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    rs_thread_pool pool(threads);
+    rs_stream_report report;
+
+    detail::rs_file_dispatch(ecc, [&](auto codec) {
+        using stream = rs_stream<typename decltype(codec)::RS>;
+
+        if (mode == "encode")
+            report = stream::encode(pool, STDIN_FILENO, STDOUT_FILENO);
+        else
+            report = stream::decode(pool, STDIN_FILENO, STDOUT_FILENO);
+    });
+
+    if (mode == "decode" || report.status != rs_stream_status::ok) {
+        std::fprintf(stderr, "in: %llu out: %llu codewords: %llu corrected symbols: %llu failed: %llu\n",
+                (unsigned long long) report.bytes_in, (unsigned long long) report.bytes_out,
+                (unsigned long long) report.codewords, (unsigned long long) report.corrected,
+                (unsigned long long) report.failed);
+    }
+
+    switch (report.status) {
+    case rs_stream_status::ok:
+        return 0;
+    case rs_stream_status::uncorrectable:
+        return 1;
+    default:
+        return 2;
+    }
+}
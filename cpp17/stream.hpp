@@ -0,0 +1,329 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "parallel.hpp"
+#include "reed_solomon.hpp"
+
+// Streaming codec between two file descriptors. The encoded stream is a plain sequence of
+// codewords of n = charact - 1 symbols; the last one is shortened to whatever input was
+// left, so the stream needs no header and decoding only needs the same ecc.
+//
+// A reader, a worker and a writer thread pass a fixed set of reusable blocks around
+// through lock-free single-producer/single-consumer rings, so I/O overlaps with coding.
+// A side that finds its ring full or empty spins briefly, then sleeps until the other side
+// moves. The worker spreads each block over a thread pool.
+
+namespace detail {
+    template<typename T, unsigned N>
+    class spsc_ring {
+        static_assert(N > 0 && (N & (N - 1)) == 0);
+
+    public:
+        inline bool try_push(T const& v) {
+            if (!push_once(v))
+                return false;
+            wake();
+            return true;
+        }
+
+        inline bool try_pop(T& v) {
+            if (!pop_once(v))
+                return false;
+            wake();
+            return true;
+        }
+
+        inline void push(T const& v) {
+            wait_for([&] { return push_once(v); });
+            wake();
+        }
+
+        inline T pop() {
+            T v;
+            wait_for([&] { return pop_once(v); });
+            wake();
+            return v;
+        }
+
+    private:
+        static constexpr unsigned spins = 64;
+
+        inline bool push_once(T const& v) {
+            auto t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N)
+                return false;
+
+            items[t % N] = v;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        inline bool pop_once(T& v) {
+            auto h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return false;
+
+            v = items[h % N];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        template<typename F>
+        inline void wait_for(F&& attempt) {
+            for (unsigned i = 0; i < spins; ++i) {
+                if (attempt())
+                    return;
+                std::this_thread::yield();
+            }
+
+            std::unique_lock<std::mutex> guard(lock);
+            sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            while (!attempt())
+                cv.wait(guard);
+
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Pairs with the fence after a sleeper registers under the lock: either its next
+        // attempt sees the new head or tail, or this sees the sleeper and the lock orders the
+        // notify after its wait
+        inline void wake() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_relaxed) == 0)
+                return;
+
+            std::lock_guard<std::mutex> guard(lock);
+            cv.notify_all();
+        }
+
+        T items[N];
+        alignas(64) std::atomic<unsigned> head{0};
+        alignas(64) std::atomic<unsigned> tail{0};
+        alignas(64) std::atomic<unsigned> sleepers{0};
+        std::mutex lock;
+        std::condition_variable cv;
+    };
+
+    static inline size_t read_full(int fd, uint8_t *buf, size_t len, bool& error) {
+        size_t done = 0;
+        while (done < len) {
+            auto r = ::read(fd, buf + done, len - done);
+            if (r == 0)
+                break;
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                error = true;
+                break;
+            }
+            done += size_t(r);
+        }
+        return done;
+    }
+
+    static inline bool write_full(int fd, const uint8_t *buf, size_t len) {
+        while (len > 0) {
+            auto r = ::write(fd, buf, len);
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            buf += r;
+            len -= size_t(r);
+        }
+        return true;
+    }
+}
+
+enum class rs_stream_status {
+    ok = 0,
+    io_error,
+    uncorrectable,      // some codewords were passed through unrepaired
+};
+
+struct rs_stream_report {
+    rs_stream_status status = rs_stream_status::ok;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    uint64_t codewords = 0;
+    uint64_t corrected = 0;     // symbols
+    uint64_t failed = 0;        // codewords
+};
+
+template<typename RS, unsigned Codewords = 1024, unsigned Depth = 4>
+struct rs_stream {
+    static_assert(std::is_same_v<typename RS::GF::Repr, uint8_t>);
+
+    static constexpr unsigned n = RS::GF::charact - 1;
+    static constexpr unsigned data_len = n - RS::ecc;
+
+    static inline rs_stream_report encode(rs_thread_pool& pool, int in_fd, int out_fd) {
+        return run(in_fd, out_fd, data_len, n, [&](block& b, rs_stream_report&) {
+            const unsigned full = unsigned(b.in_len / data_len);
+            const unsigned tail = unsigned(b.in_len % data_len);
+
+            pool.run(full, 64, [&](uint32_t begin, uint32_t end, unsigned) {
+                for (uint32_t i = begin; i < end; ++i) {
+                    auto cw = &b.out[size_t(i) * n];
+                    std::copy_n(&b.in[size_t(i) * data_len], data_len, cw);
+                    RS::encode(cw + data_len, cw, data_len);
+                }
+            });
+
+            b.out_len = size_t(full) * n;
+
+            if (tail) {
+                auto cw = &b.out[b.out_len];
+                std::copy_n(&b.in[size_t(full) * data_len], tail, cw);
+                RS::encode(cw + tail, cw, tail);
+                b.out_len += tail + RS::ecc;
+            }
+
+            b.codewords = full + !!tail;
+        });
+    }
+
+    // Verifies and repairs the stream, writing only the data symbols
+    static inline rs_stream_report decode(rs_thread_pool& pool, int in_fd, int out_fd) {
+        return run(in_fd, out_fd, n, data_len, [&](block& b, rs_stream_report& report) {
+            const unsigned full = unsigned(b.in_len / n);
+            const unsigned tail = unsigned(b.in_len % n);
+
+            report.failed += pool.run(full, RS::batch_chunk, [&](uint32_t begin, uint32_t end, unsigned) {
+                auto failed = RS::decode_batch(&b.in[size_t(begin) * n], end - begin, data_len, &b.results[begin]);
+
+                for (uint32_t i = begin; i < end; ++i)
+                    std::copy_n(&b.in[size_t(i) * n], data_len, &b.out[size_t(i) * data_len]);
+
+                return failed;
+            });
+
+            for (unsigned i = 0; i < full; ++i)
+                report.corrected += b.results[i].corrected;
+
+            b.out_len = size_t(full) * data_len;
+            b.codewords = full;
+
+            if (tail) {
+                b.codewords += 1;
+
+                if (tail <= RS::ecc) {
+                    report.failed += 1;
+                } else {
+                    auto cw = &b.in[size_t(full) * n];
+                    auto r = RS::decode(cw, tail - RS::ecc, cw + tail - RS::ecc);
+                    report.failed += !r;
+                    report.corrected += r.corrected;
+
+                    std::copy_n(cw, tail - RS::ecc, &b.out[b.out_len]);
+                    b.out_len += tail - RS::ecc;
+                }
+            }
+        });
+    }
+
+private:
+    struct block {
+        std::vector<uint8_t> in;
+        std::vector<uint8_t> out;
+        std::vector<typename RS::result> results;
+        size_t in_len = 0;
+        size_t out_len = 0;
+        unsigned codewords = 0;
+        bool last = false;
+    };
+
+    template<typename F>
+    static inline rs_stream_report run(int in_fd, int out_fd,
+            unsigned in_unit, unsigned out_unit, F&& process) {
+        std::vector<block> blocks(Depth);
+        for (auto& b : blocks) {
+            b.in.resize(size_t(Codewords) * in_unit);
+            b.out.resize(size_t(Codewords) * out_unit);
+            b.results.resize(Codewords);
+        }
+
+        detail::spsc_ring<block *, Depth> free, filled, processed;
+        for (auto& b : blocks)
+            free.push(&b);
+
+        std::atomic<bool> read_error{false};
+        std::atomic<bool> write_error{false};
+        std::atomic<uint64_t> bytes_in{0};
+        std::atomic<uint64_t> bytes_out{0};
+
+        std::thread reader([&] {
+            for (;;) {
+                auto b = free.pop();
+                bool error = false;
+
+                b->in_len = detail::read_full(in_fd, b->in.data(), b->in.size(), error);
+                b->last = error || b->in_len < b->in.size() || write_error.load(std::memory_order_relaxed);
+                bytes_in.fetch_add(b->in_len, std::memory_order_relaxed);
+
+                if (error)
+                    read_error = true;
+
+                filled.push(b);
+                if (b->last)
+                    return;
+            }
+        });
+
+        std::thread writer([&] {
+            for (;;) {
+                auto b = processed.pop();
+
+                if (!write_error.load(std::memory_order_relaxed)) {
+                    if (detail::write_full(out_fd, b->out.data(), b->out_len))
+                        bytes_out.fetch_add(b->out_len, std::memory_order_relaxed);
+                    else
+                        write_error = true;
+                }
+
+                bool last = b->last;
+                free.push(b);
+                if (last)
+                    return;
+            }
+        });
+
+        rs_stream_report report;
+
+        for (;;) {
+            auto b = filled.pop();
+            process(*b, report);
+            report.codewords += b->codewords;
+
+            bool last = b->last;
+            processed.push(b);
+            if (last)
+                break;
+        }
+
+        reader.join();
+        writer.join();
+
+        report.bytes_in = bytes_in;
+        report.bytes_out = bytes_out;
+
+        if (read_error || write_error)
+            report.status = rs_stream_status::io_error;
+        else if (report.failed)
+            report.status = rs_stream_status::uncorrectable;
+
+        return report;
+    }
+};
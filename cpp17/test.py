@@ -3,6 +3,7 @@
 import ctypes
 import os
 import random
+import threading
 import time
 import sys
 
@@ -38,8 +39,22 @@ class RSC:
         self.c_lib.gf_poly_mul.restype  = ctypes.c_uint
         self.c_lib.gf_poly_eval.restype = ctypes.c_uint8
         self.c_lib.gf_poly_eval4.restype= ctypes.c_uint32
-
-        self.gf_ctx = self.c_lib.gf_init()
+        self.c_lib.decode8.restype = ctypes.c_bool
+        self.c_lib.decode64k.restype = ctypes.c_bool
+        self.c_lib.roots8.restype = ctypes.c_uint
+        self.c_lib.decode_errata.restype = ctypes.c_bool
+        self.c_lib.decode257_errata.restype = ctypes.c_bool
+        self.c_lib.ec8_reconstruct.restype = ctypes.c_bool
+        self.c_lib.decode_erasures.restype = ctypes.c_bool
+        self.c_lib.decode8_erasures.restype = ctypes.c_bool
+        self.c_lib.decode257_erasures.restype = ctypes.c_bool
+        self.c_lib.ec64k_reconstruct.restype = ctypes.c_bool
+        self.c_lib.bch63_generator.restype = ctypes.c_uint64
+        self.c_lib.bch63_45_check.restype = ctypes.c_bool
+        self.c_lib.bch63_synds.restype = ctypes.c_bool
+        self.c_lib.bch63_30_check.restype = ctypes.c_bool
+
+        self.gf_ctx = ctypes.c_void_p(self.c_lib.gf_init())
 
     def _mul(self, a, b):
         return self.c_lib._mul(self.gf_ctx, ctypes.c_uint8(a), ctypes.c_uint8(b))
@@ -133,7 +148,147 @@ class RSC:
         self.c_lib.decode257(self.gf_ctx, res, len(a))
         return list(res)
 
-if os.system('g++ -O3 -std=c++17 -Wall -shared -fPIC ./lib.cpp -o lib.so') != 0:
+    def encode8(self, a):
+        res = (ctypes.c_uint8 * len(a))(*a)
+        self.c_lib.encode8(self.gf_ctx, res, len(a))
+        return list(res)
+
+    def decode8(self, a):
+        res = (ctypes.c_uint8 * len(a))(*a)
+        ok = self.c_lib.decode8(self.gf_ctx, res, len(a))
+        return ok, list(res)
+
+    def roots8(self, a):
+        poly = (ctypes.c_uint8 * len(a))(*a)
+        roots = (ctypes.c_uint8 * len(a))()
+        n = self.c_lib.roots8(self.gf_ctx, poly, len(a), roots)
+        return sorted(roots[:n])
+
+    def decode8_positions(self, a):
+        res = (ctypes.c_uint8 * len(a))(*a)
+        pos = (ctypes.c_uint * 8)()
+        n = self.c_lib.decode8_positions(self.gf_ctx, res, len(a), pos)
+        return n, sorted(pos[:max(n, 0)]), list(res)
+
+    def decode8_batch(self, blocks):
+        size = len(blocks[0])
+        res = (ctypes.c_uint8 * (size * len(blocks)))(*[x for b in blocks for x in b])
+        corrected = (ctypes.c_int * len(blocks))()
+        failed = self.c_lib.decode8_batch(self.gf_ctx, res, len(blocks), size, corrected)
+        res = list(res)
+        return failed, list(corrected), [res[i * size:(i + 1) * size] for i in range(len(blocks))]
+
+    def encode8_parallel(self, blocks):
+        size = len(blocks[0])
+        res = (ctypes.c_uint8 * (size * len(blocks)))(*[x for b in blocks for x in b])
+        self.c_lib.encode8_parallel(self.gf_ctx, res, len(blocks), size)
+        res = list(res)
+        return [res[i * size:(i + 1) * size] for i in range(len(blocks))]
+
+    def decode8_parallel(self, blocks):
+        size = len(blocks[0])
+        res = (ctypes.c_uint8 * (size * len(blocks)))(*[x for b in blocks for x in b])
+        failed = self.c_lib.decode8_parallel(self.gf_ctx, res, len(blocks), size)
+        res = list(res)
+        return failed, [res[i * size:(i + 1) * size] for i in range(len(blocks))]
+
+    def encode8_budget(self, a, policy):
+        res = (ctypes.c_uint8 * len(a))(*a)
+        self.c_lib.encode8_budget(self.gf_ctx, res, len(a), policy)
+        return list(res)
+
+    def footprint(self, *codecs):
+        self.c_lib.footprint.restype = ctypes.c_size_t
+        return self.c_lib.footprint(self.gf_ctx, sum(1 << c for c in codecs))
+
+    def bch63(self, op, k, word):
+        res = (ctypes.c_uint8 * 8)(*word.to_bytes(8, 'big'))
+        r = getattr(self.c_lib, f'bch63_{k}_{op}')(self.gf_ctx, res)
+        return r, int.from_bytes(bytes(res), 'big')
+
+    def bch63_synds(self, t, word, policy):
+        res = (ctypes.c_uint8 * 8)(*word.to_bytes(8, 'big'))
+        synds = (ctypes.c_uint8 * 12)()
+        nonzero = self.c_lib.bch63_synds(self.gf_ctx, t, res, synds, policy)
+        return nonzero, list(synds[:2 * t])
+
+    def bch63_decode_batch(self, t, words):
+        res = (ctypes.c_uint8 * (8 * len(words)))(*b''.join(w.to_bytes(8, 'big') for w in words))
+        status = (ctypes.c_int * len(words))()
+        failed = self.c_lib.bch63_decode_batch(self.gf_ctx, t, res, len(words), status)
+        res = bytes(res)
+        return failed, list(status), [int.from_bytes(res[i * 8:i * 8 + 8], 'big') for i in range(len(words))]
+
+    def bch_long(self, op, code, data):
+        res = (ctypes.c_uint8 * len(data))(*data)
+        r = self.c_lib.bch_long(self.gf_ctx, code, ['encode', 'check', 'decode'].index(op), res)
+        return r, bytes(res)
+
+    def decode8_stats(self):
+        stats = (ctypes.c_uint64 * 4)()
+        self.c_lib.decode8_stats(self.gf_ctx, stats)
+        return list(stats)
+
+    def decode8_trace(self, stage):
+        summary = (ctypes.c_uint64 * 4)()
+        self.c_lib.decode8_trace(self.gf_ctx, stage, summary)
+        return list(summary)
+
+    def decode8_trace_errors(self):
+        errors = (ctypes.c_uint64 * 9)()
+        self.c_lib.decode8_trace_errors(self.gf_ctx, errors)
+        return list(errors)
+
+    def decode8_trace_reset(self):
+        self.c_lib.decode8_trace_reset(self.gf_ctx)
+
+    def encode64k(self, a):
+        res = (ctypes.c_uint16 * len(a))(*a)
+        self.c_lib.encode64k(self.gf_ctx, res, len(a))
+        return list(res)
+
+    def decode64k(self, a):
+        res = (ctypes.c_uint16 * len(a))(*a)
+        ok = self.c_lib.decode64k(self.gf_ctx, res, len(a))
+        return ok, list(res)
+
+    def ec_encode(self, name, ctype, frags):
+        res = (ctype * (len(frags) * len(frags[0])))(*[x for f in frags for x in f])
+        getattr(self.c_lib, f'{name}_encode')(self.gf_ctx, res, len(frags[0]))
+        res = list(res)
+        return [res[i * len(frags[0]):(i + 1) * len(frags[0])] for i in range(len(frags))]
+
+    def ec_reconstruct(self, name, ctype, frags, erased):
+        res = (ctype * (len(frags) * len(frags[0])))(*[x for f in frags for x in f])
+        eras = (ctypes.c_uint * len(erased))(*erased)
+        ok = getattr(self.c_lib, f'{name}_reconstruct')(self.gf_ctx, res, len(frags[0]), eras, len(erased))
+        res = list(res)
+        return ok, [res[i * len(frags[0]):(i + 1) * len(frags[0])] for i in range(len(frags))]
+
+    def decode_erasures(self, name, ctype, a, erasures):
+        res = (ctype * len(a))(*a)
+        eras = (ctypes.c_uint * len(erasures))(*erasures)
+        ok = getattr(self.c_lib, name)(self.gf_ctx, res, len(a), eras, len(erasures))
+        return ok, list(res)
+
+    def erasure_plans8_stats(self):
+        stats = (ctypes.c_uint64 * 2)()
+        self.c_lib.erasure_plans8_stats(self.gf_ctx, stats)
+        return list(stats)
+
+    def decode_errata(self, a, erasures):
+        res = (ctypes.c_uint8 * len(a))(*a)
+        eras = (ctypes.c_uint * len(erasures))(*erasures)
+        ok = self.c_lib.decode_errata(self.gf_ctx, res, len(a), eras, len(erasures))
+        return ok, list(res)
+
+    def decode257_errata(self, a, erasures):
+        res = (ctypes.c_uint16 * len(a))(*a)
+        eras = (ctypes.c_uint * len(erasures))(*erasures)
+        ok = self.c_lib.decode257_errata(self.gf_ctx, res, len(a), eras, len(erasures))
+        return ok, list(res)
+
+if os.system('g++ -O3 -std=c++17 -Wall -shared -fPIC -pthread ./lib.cpp -o lib.so') != 0:
     quit()
 
 ecc_len = 4
@@ -394,6 +549,620 @@ def test_decode257():
             print(f'ref:  {ref}')
             assert False
 
+@test
+def test_decode8():
+    ecc8 = 8
+    for _ in range(10000):
+        a = [random.randrange(GF.p ** GF.k) for _ in range(random.randrange(1, 248))]
+
+        enc = RS.encode8(a + [0] * ecc8)
+
+        errors = random.randrange(ecc8 // 2 + 1)
+        for i in random.sample(range(len(enc)), errors):
+            enc[i] ^= random.randrange(1, 256)
+
+        ok, dec = RS.decode8(enc)
+
+        if not ok or dec[:len(a)] != a:
+            print(f'data: {a}')
+            print(f'dec:  {dec}')
+            assert False
+
+@test
+def test_roots8():
+    for _ in range(5000):
+        deg = random.randrange(1, 6)
+        if random.randrange(2):
+            pos = random.sample(range(255), deg)
+            p = gf.P(GF, [1])
+            for i in pos:
+                p *= gf.P(GF, [1, GF.gen(i)])
+            ref = sorted(pos)
+        else:
+            p = gf.P(GF, [1] + [random.randrange(GF.p ** GF.k) for _ in range(deg)])
+            ref = [i for i in range(255) if int(p.eval(GF.gen(i).inv())) == 0]
+
+        a = list(map(int, p.x[::-1]))
+        res = RS.roots8(a)
+
+        if len(ref) == deg and res != ref:
+            print(f'poly: {a}')
+            print(f'roots: {res} ref: {ref}')
+            assert False
+        assert len(res) <= len(ref)
+
+@test
+def test_decode8_positions():
+    ecc8 = 8
+    blocks, clean, symbols, failed = RS.decode8_stats()
+
+    for _ in range(2000):
+        a = [random.randrange(GF.p ** GF.k) for _ in range(random.randrange(1, 248))]
+
+        enc = RS.encode8(a + [0] * ecc8)
+
+        errors = random.randrange(ecc8 // 2 + 2)
+        pos = random.sample(range(len(enc)), min(errors, len(enc)))
+        for i in pos:
+            enc[i] ^= random.randrange(1, 256)
+
+        n, res, dec = RS.decode8_positions(enc)
+
+        blocks += 1
+        if len(pos) == 0:
+            clean += 1
+        if n >= 0:
+            symbols += n
+        else:
+            failed += 1
+
+        if len(pos) <= ecc8 // 2:
+            assert n == len(pos) and res == sorted(pos) and dec[:len(a)] == a, (n, res, sorted(pos))
+
+    assert RS.decode8_stats() == [blocks, clean, symbols, failed]
+
+@test
+def test_decode8_trace():
+    ecc8 = 8
+    synds, berlekamp_massey, roots, forney, correct, total = range(6)
+    RS.decode8_trace_reset()
+
+    blocks = []
+    degrees = [0] * (ecc8 + 1)
+    for _ in range(1000):
+        a = [random.randrange(GF.p ** GF.k) for _ in range(random.randrange(1, 248))]
+        enc = RS.encode8(a + [0] * ecc8)
+
+        pos = random.sample(range(len(enc)), min(random.randrange(ecc8 // 2 + 3), len(enc)))
+        for i in pos:
+            enc[i] ^= random.randrange(1, 256)
+
+        RS.decode8(enc)
+        blocks.append(enc)
+        if len(pos) <= ecc8 // 2:
+            degrees[len(pos)] += 1
+
+    # every block has syndromes and a total, only dirty ones reach the locator
+    assert RS.decode8_trace(synds)[0] == RS.decode8_trace(total)[0] == len(blocks)
+    assert RS.decode8_trace(berlekamp_massey)[0] == len(blocks) - degrees[0]
+    assert RS.decode8_trace(forney)[0] >= sum(degrees[1:])
+
+    # heavily corrupted blocks may still get a locator of low degree
+    found = RS.decode8_trace_errors()
+    assert sum(found) == len(blocks) and found[0] == degrees[0]
+    assert all(f >= d for f, d in zip(found, degrees))
+
+    for s in range(6):
+        count, p50, p99, p999 = RS.decode8_trace(s)
+        assert count == 0 or p50 <= p99 <= p999, (s, p50, p99, p999)
+    assert RS.decode8_trace(total)[1] >= RS.decode8_trace(synds)[1]
+
+    # threads that have exited and pool threads that are still alive both count
+    t = threading.Thread(target=lambda: [RS.decode8(b) for b in blocks[:10]])
+    t.start()
+    t.join()
+    assert RS.decode8_trace(total)[0] == len(blocks) + 10
+
+    size = 64
+    RS.decode8_parallel([RS.encode8([random.randrange(256) for _ in range(size - ecc8)] + [0] * ecc8) for _ in range(100)])
+    assert RS.decode8_trace(total)[0] == len(blocks) + 110
+
+    RS.decode8_trace_reset()
+    assert RS.decode8_trace(total)[0] == 0 and sum(RS.decode8_trace_errors()) == 0
+
+@test
+def test_decode8_batch():
+    ecc8 = 8
+    for _ in range(50):
+        size = random.randrange(ecc8 + 1, 256)
+        count = random.randrange(1, 200)
+
+        blocks = []
+        for _ in range(count):
+            enc = RS.encode8([random.randrange(GF.p ** GF.k) for _ in range(size - ecc8)] + [0] * ecc8)
+            if random.randrange(4) == 0:
+                for i in random.sample(range(size), random.randrange(1, ecc8)):
+                    enc[i] ^= random.randrange(1, 256)
+            blocks.append(enc)
+
+        ref = [RS.decode8_positions(b) for b in blocks]
+        failed, corrected, dec = RS.decode8_batch(blocks)
+
+        assert failed == sum(n < 0 for n, _, _ in ref)
+        assert corrected == [n for n, _, _ in ref]
+        assert dec == [d for _, _, d in ref]
+
+@test
+def test_parallel8():
+    ecc8 = 8
+    for _ in range(5):
+        size = random.randrange(ecc8 + 1, 256)
+        count = random.randrange(1, 1000)
+
+        msgs = [[random.randrange(GF.p ** GF.k) for _ in range(size - ecc8)] + [0] * ecc8 for _ in range(count)]
+        blocks = RS.encode8_parallel(msgs)
+        assert blocks == [RS.encode8(m) for m in msgs]
+
+        for b in blocks:
+            if random.randrange(4) == 0:
+                for i in random.sample(range(size), random.randrange(1, ecc8)):
+                    b[i] ^= random.randrange(1, 256)
+
+        failed, dec = RS.decode8_parallel(blocks)
+        ref = [RS.decode8_positions(b) for b in blocks]
+
+        assert failed == sum(n < 0 for n, _, _ in ref)
+        assert dec == [d for _, _, d in ref]
+
+@test
+def test_decode64k():
+    ecc16 = 8
+    for _ in range(2000):
+        a = [random.randrange(GF64k.p ** GF64k.k) for _ in range(random.randrange(1, 1000))]
+
+        enc = RS.encode64k(a + [0] * ecc16)
+
+        errors = random.randrange(ecc16 // 2 + 1)
+        for i in random.sample(range(len(enc)), errors):
+            enc[i] ^= random.randrange(1, 2 ** 16)
+
+        ok, dec = RS.decode64k(enc)
+
+        if not ok or dec[:len(a)] != a:
+            print(f'data: {a}')
+            print(f'dec:  {dec}')
+            assert False
+
+@test
+def test_decode_errata():
+    for _ in range(10000):
+        a = [random.randrange(GF.p ** GF.k) for _ in range(16)]
+
+        enc = RS.encode(a + [0] * ecc_len)
+
+        erasures = random.randrange(ecc_len + 1)
+        errors = random.randrange((ecc_len - erasures) // 2 + 1)
+        pos = random.sample(range(len(enc)), erasures + errors)
+
+        for i in pos[:erasures]:
+            enc[i] = random.randrange(GF.p ** GF.k)
+        for i in pos[erasures:]:
+            enc[i] ^= random.randrange(1, 256)
+
+        ok, dec = RS.decode_errata(enc, pos[:erasures])
+
+        if not ok or dec[:len(a)] != a:
+            print(f'data: {a}')
+            print(f'dec:  {dec}')
+            print(f'erasures: {pos[:erasures]} errors: {pos[erasures:]}')
+            assert False
+
+@test
+def test_decode257_errata():
+    for _ in range(10000):
+        a = [random.randrange(GF257.p) for _ in range(16)]
+
+        enc = RS.encode257(a + [0] * ecc_len)
+
+        erasures = random.randrange(ecc_len + 1)
+        errors = random.randrange((ecc_len - erasures) // 2 + 1)
+        pos = random.sample(range(len(enc)), erasures + errors)
+
+        for i in pos[:erasures]:
+            enc[i] = random.randrange(GF257.p)
+        for i in pos[erasures:]:
+            enc[i] = int(GF257(enc[i]) + GF257(random.randrange(1, GF257.p - 1)))
+
+        ok, dec = RS.decode257_errata(enc, pos[:erasures])
+
+        if not ok or dec[:len(a)] != a:
+            print(f'data: {a}')
+            print(f'dec:  {dec}')
+            print(f'erasures: {pos[:erasures]} errors: {pos[erasures:]}')
+            assert False
+
+@test
+def test_decode_erasures():
+    for name, ctype, field, encode, ecc in [
+            ('decode_erasures', ctypes.c_uint8, GF, RS.encode, ecc_len),
+            ('decode8_erasures', ctypes.c_uint8, GF, RS.encode8, 8),
+            ('decode257_erasures', ctypes.c_uint16, GF257, RS.encode257, ecc_len)]:
+        for _ in range(50):
+            size = random.randrange(ecc + 1, 200)
+            pattern = random.sample(range(size), random.randrange(ecc + 1))
+
+            for _ in range(20):
+                a = [random.randrange(field.p ** field.k) for _ in range(size - ecc)]
+                enc = encode(a + [0] * ecc)
+
+                for i in pattern:
+                    enc[i] = random.randrange(field.p ** field.k)
+
+                ok, dec = RS.decode_erasures(name, ctype, enc, pattern)
+                assert ok and dec[:len(a)] == a, (name, pattern)
+
+@test
+def test_erasure_plans8():
+    hits, misses = RS.erasure_plans8_stats()
+    size = 100
+    pattern = random.sample(range(size), 8)
+
+    for _ in range(10):
+        enc = RS.encode8([random.randrange(256) for _ in range(size - 8)] + [0] * 8)
+        ref = list(enc)
+        for i in pattern:
+            enc[i] ^= random.randrange(1, 256)
+
+        ok, dec = RS.decode_erasures('decode8_erasures', ctypes.c_uint8, enc, pattern)
+        assert ok and dec == ref
+
+    assert RS.erasure_plans8_stats() == [hits + 9, misses + 1]
+
+    # the same erasure set in another order reuses the plan
+    for _ in range(5):
+        enc = RS.encode8([random.randrange(256) for _ in range(size - 8)] + [0] * 8)
+        ref = list(enc)
+        for i in pattern:
+            enc[i] ^= random.randrange(1, 256)
+
+        ok, dec = RS.decode_erasures('decode8_erasures', ctypes.c_uint8, enc, random.sample(pattern, len(pattern)))
+        assert ok and dec == ref
+
+    assert RS.erasure_plans8_stats() == [hits + 14, misses + 1]
+
+    enc = RS.encode8([0] * (size - 8) + [0] * 8)
+    enc[3] = 1
+    ok, _ = RS.decode_erasures('decode8_erasures', ctypes.c_uint8, enc, [3, 3])
+    assert not ok
+
+@test
+def test_encode8_budget():
+    for size in [9, 20, 100, 255]:
+        a = [random.randrange(256) for _ in range(size - 8)] + [0] * 8
+        ref = RS.encode8(a)
+        for policy in range(4):
+            assert RS.encode8_budget(a, policy) == ref, (size, policy)
+
+@test
+def test_footprint():
+    rs0, rs1, rs2, rs3, nibble, b512, b4k, b64k = range(8)
+
+    # exp/log tables of GF(2^8) are shared between codecs with different policy packs
+    assert RS.footprint(rs0, rs2) < RS.footprint(rs0) + RS.footprint(rs2)
+
+    # every codec at ecc 8 shares the generator and field tables, only the encoder differs
+    assert RS.footprint(nibble) == RS.footprint(b512)
+    # nibble tables (32 * ecc), one 256-entry lut (256 * ecc), slice-by-16 (16 * 256 * 8)
+    assert RS.footprint(b4k) - RS.footprint(b512) == 256 * 8 - 32 * 8
+    assert RS.footprint(b64k) - RS.footprint(b4k) == 16 * 256 * 8 - 256 * 8
+    assert RS.footprint(b512, b4k, b64k) == RS.footprint(b64k) + 256 * 8 + 32 * 8
+
+@test
+def test_bch63():
+    assert RS.c_lib.bch63_generator(RS.gf_ctx, 3) == 0x782cf
+    assert RS.c_lib.bch63_generator(RS.gf_ctx, 6) == 0x37cd0eb67
+
+    assert os.system('gcc -O2 -shared -fPIC ../bch/bch.c -o bch_c.so') == 0
+    bch_c = ctypes.CDLL('./bch_c.so')
+    os.remove('bch_c.so')
+
+    for k, t in [(45, 3), (30, 6)]:
+        for _ in range(2000):
+            # bch.c sets the unused last bit, start from the same value
+            word = random.randrange(2 ** 64) | 1
+            _, enc = RS.bch63('encode', k, word)
+
+            ref = ctypes.create_string_buffer(word.to_bytes(8, 'big'), 8)
+            getattr(bch_c, f'encode63_{k}')(ref)
+            assert enc == int.from_bytes(ref.raw, 'big'), (k, hex(word))
+            assert enc >> (64 - k) == word >> (64 - k)
+
+            ok, _ = RS.bch63('check', k, enc)
+            assert ok
+
+            bits = random.sample(range(63), random.randrange(t + 1))
+            rx = enc
+            for b in bits:
+                rx ^= 1 << (63 - b)
+
+            ok, _ = RS.bch63('check', k, rx)
+            assert ok == (not bits)
+
+            corrected, dec = RS.bch63('decode', k, rx)
+            assert corrected == len(bits) and dec == enc, (k, bits)
+
+        # more than t errors never decode to a different word silently when the locator fails
+        fails = 0
+        for _ in range(200):
+            rx = enc
+            for b in random.sample(range(63), t + 1):
+                rx ^= 1 << (63 - b)
+            corrected, dec = RS.bch63('decode', k, rx)
+            fails += corrected < 0
+            assert corrected < 0 or dec != enc
+        assert fails > 0
+
+@test
+def test_bch63_synds():
+    for t, k in [(3, 45), (6, 30)]:
+        for _ in range(2000):
+            word = random.randrange(2 ** 64)
+            # the basic path evaluates even syndromes directly, minpoly squares odd ones
+            basic = RS.bch63_synds(t, word, 0)
+            assert basic == RS.bch63_synds(t, word, 1), (t, hex(word))
+            assert basic == RS.bch63_synds(t, word, 2), (t, hex(word))
+
+        _, enc = RS.bch63('encode', k, random.randrange(2 ** 64))
+        assert RS.bch63_synds(t, enc, 1) == (False, [0] * 2 * t)
+        assert RS.bch63_synds(t, enc, 2) == (False, [0] * 2 * t)
+
+@test
+def test_bch63_batch():
+    for t, k in [(3, 45), (6, 30)]:
+        # not a multiple of the group size, so the last group is partial
+        for count in [1, 63, 700]:
+            sent = [RS.bch63('encode', k, random.randrange(2 ** 64))[1] for _ in range(count)]
+            rx = list(sent)
+            errors = [0] * count
+            for i in random.sample(range(count), count // 4 + 1):
+                errors[i] = random.randrange(1, t + 3)
+                for b in random.sample(range(63), errors[i]):
+                    rx[i] ^= 1 << (63 - b)
+
+            failed, status, dec = RS.bch63_decode_batch(t, rx)
+
+            ref = [RS.bch63('decode', k, w) for w in rx]
+            assert status == [r[0] for r in ref], (t, count)
+            assert dec == [r[1] for r in ref], (t, count)
+            assert failed == sum(s < 0 for s in status)
+            assert all(d == s for d, s, e in zip(dec, sent, errors) if e <= t)
+
+@test
+def test_bch_long():
+    # code: (n, t, reference code with the bit-serial encoder, basic syndromes and plain Chien)
+    codes = {0: (4616, 40, 1), 2: (17464, 72, None), 3: (8191, 8, None)}
+
+    for code, (n, t, ref) in codes.items():
+        size = (n + 7) // 8
+        for _ in range(20):
+            data = random.randbytes(size)
+            _, enc = RS.bch_long('encode', code, data)
+            if ref is not None:
+                assert RS.bch_long('encode', ref, data)[1] == enc
+
+            # bits past n are left untouched
+            if n % 8:
+                assert enc[-1] & ((1 << (8 - n % 8)) - 1) == data[-1] & ((1 << (8 - n % 8)) - 1)
+            assert RS.bch_long('check', code, enc)[0]
+
+            bits = random.sample(range(n), random.randrange(t + 1))
+            rx = bytearray(enc)
+            for b in bits:
+                rx[b // 8] ^= 0x80 >> (b % 8)
+            assert RS.bch_long('check', code, rx)[0] == (not bits)
+
+            corrected, dec = RS.bch_long('decode', code, rx)
+            assert corrected == len(bits) and dec == enc, (code, sorted(bits))
+            if ref is not None:
+                assert RS.bch_long('decode', ref, rx) == (corrected, dec)
+
+            bits = random.sample(range(n), t + 1 + random.randrange(t))
+            rx = bytearray(enc)
+            for b in bits:
+                rx[b // 8] ^= 0x80 >> (b % 8)
+            corrected, dec = RS.bch_long('decode', code, rx)
+            assert corrected < 0 or dec != enc
+            if ref is not None:
+                assert RS.bch_long('decode', ref, rx) == (corrected, dec)
+
+@test
+def test_file_protect():
+    import subprocess
+    import tempfile
+
+    assert os.system('g++ -O2 -std=c++17 -Wall -pthread ./protect.cpp -o protect') == 0
+
+    def run(*args):
+        return subprocess.run(['./protect', *args], stdout=subprocess.DEVNULL).returncode
+
+    with tempfile.TemporaryDirectory() as tmp:
+        for ecc, interleave in [(2, 1), (8, 16), (32, 7)]:
+            path = os.path.join(tmp, 'data')
+            size = random.randrange(1, 300000)
+            orig = bytes(random.randrange(256) for _ in range(size))
+            with open(path, 'wb') as f:
+                f.write(orig)
+
+            assert run('encode', path, '-e', str(ecc), '-i', str(interleave), '-t', '3') == 0
+            assert run('verify', path) == 0
+
+            # burst that every codeword can absorb
+            burst = interleave * (ecc // 2)
+            start = random.randrange(max(1, size - burst))
+            damaged = bytearray(orig)
+            for i in range(start, min(size, start + burst)):
+                damaged[i] ^= random.randrange(1, 256)
+            with open(path, 'wb') as f:
+                f.write(damaged)
+
+            assert run('verify', path) == 1
+            assert run('repair', path) == 0
+            with open(path, 'rb') as f:
+                assert f.read() == orig
+
+        with open(path, 'ab') as f:
+            f.write(b'x')
+        assert run('verify', path) == 2
+
+    os.remove('protect')
+
+@test
+def test_stream():
+    import subprocess
+
+    assert os.system('g++ -O2 -std=c++17 -Wall -pthread ./rsstream.cpp -o rsstream') == 0
+
+    def run(*args, data):
+        p = subprocess.run(['./rsstream', *args], input=data, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+        return p.returncode, p.stdout
+
+    for ecc in [2, 8, 32]:
+        n = 255
+        for size in [0, 1, n - ecc, n - ecc + 1, random.randrange(300000, 600000)]:
+            data = bytes(random.randrange(256) for _ in range(size))
+
+            rc, enc = run('encode', '-e', str(ecc), '-t', '2', data=data)
+            assert rc == 0
+            codewords = -(-size // (n - ecc))
+            assert len(enc) == size + codewords * ecc
+
+            damaged = bytearray(enc)
+            for k in range(0, len(damaged), n):
+                for i in random.sample(range(min(n, len(damaged) - k)), min(ecc // 2, len(damaged) - k)):
+                    damaged[k + i] ^= random.randrange(1, 256)
+
+            rc, dec = run('decode', '-e', str(ecc), data=bytes(damaged))
+            assert rc == 0 and dec == data
+
+    os.remove('rsstream')
+
+@test
+def test_ffrs_module():
+    import importlib
+    import sysconfig
+
+    target = 'ffrs' + sysconfig.get_config_var('EXT_SUFFIX')
+    include = sysconfig.get_paths()['include']
+    assert os.system(f'g++ -O2 -std=c++17 -Wall -shared -fPIC -pthread -I{include} ./pyffrs.cpp -o {target}') == 0
+
+    sys.path.insert(0, '.')
+    ffrs = importlib.import_module('ffrs')
+
+    ecc8 = 8
+    row = random.randrange(ecc8 + 1, 256)
+    rows = 500
+    msgs = [[random.randrange(256) for _ in range(row - ecc8)] + [0] * ecc8 for _ in range(rows)]
+
+    src = bytes(x for m in msgs for x in m)
+    out = ffrs.encode(src, ecc=ecc8, row=row)
+    assert isinstance(out, bytearray) and src == bytes(x for m in msgs for x in m)
+    enc = [list(out[i * row:(i + 1) * row]) for i in range(rows)]
+    assert enc == [RS.encode8(m) for m in msgs]
+
+    buf = bytearray(src)
+    assert ffrs.encode(buf, ecc=ecc8, row=row, out=buf) is buf and buf == out
+
+    expected = []
+    for i in range(rows):
+        errors = random.randrange(ecc8)
+        for j in random.sample(range(row), errors):
+            buf[i * row + j] ^= random.randrange(1, 256)
+        expected.append(sorted(j for j in range(row) if buf[i * row + j] != out[i * row + j]))
+
+    damaged = bytes(buf)
+    fixed = bytearray(len(buf))
+    checked, checked_pos = ffrs.check(damaged, ecc=ecc8, row=row, out=fixed, positions=True)
+    assert ffrs.check(damaged, ecc=ecc8, row=row) == checked
+
+    status, positions = ffrs.decode(memoryview(buf), ecc=ecc8, row=row, positions=True)
+    assert len(status) == rows and len(positions) == rows * ecc8
+    assert status == checked and positions == checked_pos and buf == fixed
+    for i, (st, errors) in enumerate(zip(status, expected)):
+        st = st - 256 if st >= 128 else st
+        if len(errors) <= ecc8 // 2:
+            pos = list(positions[i * ecc8:(i + 1) * ecc8])
+            assert st == len(errors) and list(buf[i * row:(i + 1) * row]) == enc[i]
+            assert sorted(pos[:st]) == errors and pos[st:] == [0xff] * (ecc8 - st)
+
+    try:
+        ffrs.decode(damaged, ecc=ecc8, row=row)
+        assert False
+    except BufferError:
+        pass
+
+    try:
+        ffrs.encode(src, ecc=ecc8, row=row, out=bytearray(len(src) - row))
+        assert False
+    except ValueError:
+        pass
+
+    try:
+        import numpy
+    except ImportError:
+        numpy = None
+
+    if numpy is not None:
+        arr = numpy.zeros((rows, 255), dtype=numpy.uint8)
+        arr[:, :-16] = numpy.random.randint(0, 256, (rows, 255 - 16))
+        ffrs.encode(arr, ecc=16, out=arr)
+        ref = arr.copy()
+        arr[:, 3] ^= 1
+        status = numpy.frombuffer(ffrs.decode(arr, ecc=16), dtype=numpy.int8)
+        assert (status == 1).all() and (arr == ref).all()
+
+    for bad in [dict(ecc=3), dict(row=ecc8), dict(row=256)]:
+        try:
+            ffrs.decode(buf, **{'ecc': ecc8, 'row': row, **bad})
+            assert False
+        except ValueError:
+            pass
+
+    sys.path.pop(0)
+    os.remove(target)
+
+def _test_erasure_code(name, ctype, field, k, m):
+    for _ in range(200):
+        length = random.randrange(1, 300)
+        data = [[random.randrange(field.p ** field.k) for _ in range(length)] for _ in range(k)]
+        frags = RS.ec_encode(name, ctype, data + [[0] * length for _ in range(m)])
+
+        assert frags[:k] == data
+        for i in range(m):
+            coef = [field(1) // (field(k + i) + field(j)) for j in range(k)]
+            for x in random.sample(range(length), min(length, 4)):
+                p = field(0)
+                for j in range(k):
+                    p = p + coef[j] * field(data[j][x])
+                assert frags[k + i][x] == int(p)
+
+        erased = random.sample(range(k + m), random.randrange(m + 1))
+        damaged = [[random.randrange(field.p ** field.k) for _ in range(length)] if i in erased else f
+                for i, f in enumerate(frags)]
+
+        ok, rebuilt = RS.ec_reconstruct(name, ctype, damaged, erased)
+        assert ok and rebuilt == frags
+
+    ok, _ = RS.ec_reconstruct(name, ctype, frags, random.sample(range(k + m), m + 1))
+    assert not ok
+
+@test
+def test_erasure_code8():
+    _test_erasure_code('ec8', ctypes.c_uint8, GF, 6, 3)
+
+@test
+def test_erasure_code64k():
+    _test_erasure_code('ec64k', ctypes.c_uint16, GF64k, 10, 4)
+
 if __name__ == '__main__':
     random.seed(42)
     test_mul()
@@ -415,3 +1184,25 @@ if __name__ == '__main__':
     test_decode()
     test_encode257()
     test_decode257()
+    test_roots8()
+    test_decode8()
+    test_decode8_positions()
+    test_decode8_trace()
+    test_decode8_batch()
+    test_parallel8()
+    test_decode64k()
+    test_decode_errata()
+    test_decode257_errata()
+    test_decode_erasures()
+    test_erasure_plans8()
+    test_encode8_budget()
+    test_footprint()
+    test_bch63()
+    test_bch63_synds()
+    test_bch63_batch()
+    test_bch_long()
+    test_erasure_code8()
+    test_erasure_code64k()
+    test_file_protect()
+    test_stream()
+    test_ffrs_module()